@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/bench/allocation_counter.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/allocation_counter.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/allocation_counter.cpp.o.d"
+  "/root/repo/bench/btree_bench.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/btree_bench.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/btree_bench.cpp.o.d"
+  "/root/repo/bench/container_bench.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/container_bench.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/container_bench.cpp.o.d"
+  "/root/repo/bench/insert_batch_bench.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/insert_batch_bench.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/insert_batch_bench.cpp.o.d"
+  "/root/repo/bench/main.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/main.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/main.cpp.o.d"
+  "/root/repo/bench/serialization_bench.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/serialization_bench.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/serialization_bench.cpp.o.d"
+  "/root/repo/bench/splay_bench.cpp" "bench/CMakeFiles/binary_search_tree_bench.dir/splay_bench.cpp.o" "gcc" "bench/CMakeFiles/binary_search_tree_bench.dir/splay_bench.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_bench_native/lib/CMakeFiles/binary_search_tree.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
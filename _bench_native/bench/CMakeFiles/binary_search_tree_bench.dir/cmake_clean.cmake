@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/binary_search_tree_bench.dir/allocation_counter.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/allocation_counter.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/btree_bench.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/btree_bench.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/container_bench.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/container_bench.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/insert_batch_bench.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/insert_batch_bench.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/main.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/main.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/serialization_bench.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/serialization_bench.cpp.o.d"
+  "CMakeFiles/binary_search_tree_bench.dir/splay_bench.cpp.o"
+  "CMakeFiles/binary_search_tree_bench.dir/splay_bench.cpp.o.d"
+  "binary_search_tree_bench"
+  "binary_search_tree_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/binary_search_tree_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
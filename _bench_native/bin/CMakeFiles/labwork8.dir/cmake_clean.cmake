@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/labwork8.dir/main.cpp.o"
+  "CMakeFiles/labwork8.dir/main.cpp.o.d"
+  "labwork8"
+  "labwork8.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/labwork8.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
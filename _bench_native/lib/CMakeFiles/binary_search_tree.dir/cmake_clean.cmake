@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/binary_search_tree.dir/BinarySearchTree.cpp.o"
+  "CMakeFiles/binary_search_tree.dir/BinarySearchTree.cpp.o.d"
+  "CMakeFiles/binary_search_tree.dir/MappedFile.cpp.o"
+  "CMakeFiles/binary_search_tree.dir/MappedFile.cpp.o.d"
+  "libbinary_search_tree.a"
+  "libbinary_search_tree.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/binary_search_tree.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
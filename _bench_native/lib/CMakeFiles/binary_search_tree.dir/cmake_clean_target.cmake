@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libbinary_search_tree.a"
+)
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    double elapsed_ns() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+template<class T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline std::uint64_t next_random(std::uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+template<class T>
+void shuffle(std::vector<T>& values, std::uint64_t& state) {
+    for (std::size_t i = values.size(); i > 1; --i) {
+        std::swap(values[i - 1], values[next_random(state) % i]);
+    }
+}
+
+// Draws ranks with probability proportional to 1 / rank^0.99 and maps them onto shuffled keys,
+// so the hot keys are spread over the whole key range.
+class ZipfGenerator {
+public:
+    ZipfGenerator(std::size_t n, std::uint64_t& state) : cdf_(n), keys_(n), state_(state) {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+            cdf_[i] = sum;
+            keys_[i] = 2 * i;
+        }
+        shuffle(keys_, state_);
+    }
+
+    std::uint64_t next() {
+        double point = static_cast<double>(next_random(state_) >> 11) * 0x1.0p-53 * cdf_.back();
+        std::size_t rank = std::upper_bound(cdf_.begin(), cdf_.end(), point) - cdf_.begin();
+        return keys_[std::min(rank, keys_.size() - 1)];
+    }
+
+private:
+    std::vector<double> cdf_;
+    std::vector<std::uint64_t> keys_;
+    std::uint64_t& state_;
+};
+
+// Key wrapper that counts every comparison made through it, so containers are compared on the same key type.
+inline std::uint64_t comparison_count = 0;
+
+template<class T>
+struct Counted {
+    T value;
+
+    friend bool operator<(const Counted& lhs, const Counted& rhs) {
+        ++comparison_count;
+        return lhs.value < rhs.value;
+    }
+    friend bool operator==(const Counted& lhs, const Counted& rhs) {
+        ++comparison_count;
+        return lhs.value == rhs.value;
+    }
+    friend bool operator!=(const Counted& lhs, const Counted& rhs) {
+        ++comparison_count;
+        return lhs.value != rhs.value;
+    }
+};
+
+// Number of calls to the global operator new since the program started.
+std::uint64_t allocation_count();
+
+// Data TLB load misses of the calling thread, counted with perf_event_open. Unavailable off Linux, in
+// most containers and under a strict kernel.perf_event_paranoid; read() then returns -1.
+class TlbMissCounter {
+public:
+    TlbMissCounter();
+    TlbMissCounter(const TlbMissCounter& other) = delete;
+    ~TlbMissCounter();
+
+    TlbMissCounter& operator=(const TlbMissCounter& other) = delete;
+
+    bool available() const;
+    // Resets the count and starts counting.
+    void start();
+    // Misses since start().
+    long long read() const;
+
+private:
+    int fd_ = -1;
+};
+
+void run_container_bench(std::size_t max_size);
+void run_insert_batch_bench(std::size_t max_size);
+void run_serialization_bench(std::size_t max_size);
+void run_splay_bench(std::size_t max_size);
+void run_btree_bench(std::size_t max_size);
+void run_frozen_bench(std::size_t max_size);
+void run_projected_bench(std::size_t max_size);
+void run_string_bench(std::size_t max_size);
+void run_huge_pages_bench(std::size_t max_size);
+void run_multiplicity_bench(std::size_t max_size);
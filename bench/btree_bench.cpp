@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+#include <lib/BTree.h>
+#include <lib/CompactBinarySearchTree.h>
+#include <lib/ParentFreeBinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+struct LookupSample {
+    double insert_ns = 0;
+    double find_ns = 0;
+    double lower_bound_ns = 0;
+    bool lower_bound_measured = false;
+};
+
+// Stored keys are even and probes odd, so lower_bound never hits a key. BinarySearchTree::lower_bound
+// walks successors, so it is left out there.
+template<class Container>
+LookupSample measure(const std::vector<std::int64_t>& inserts, const std::vector<std::int64_t>& queries, bool with_lower_bound) {
+    LookupSample sample;
+    Container container;
+    {
+        Stopwatch stopwatch;
+        for (std::int64_t key : inserts) {
+            container.insert(key);
+        }
+        sample.insert_ns = stopwatch.elapsed_ns() / static_cast<double>(inserts.size());
+    }
+    {
+        std::size_t found = 0;
+        Stopwatch stopwatch;
+        for (std::int64_t key : queries) {
+            found += container.contains(key);
+        }
+        sample.find_ns = stopwatch.elapsed_ns() / static_cast<double>(queries.size());
+        do_not_optimize(found);
+    }
+    if (with_lower_bound) {
+        Stopwatch stopwatch;
+        for (std::int64_t key : queries) {
+            auto it = container.lower_bound(key + 1);
+            do_not_optimize(it);
+        }
+        sample.lower_bound_ns = stopwatch.elapsed_ns() / static_cast<double>(queries.size());
+        sample.lower_bound_measured = true;
+    }
+    return sample;
+}
+
+}
+
+void run_btree_bench(std::size_t max_size) {
+    std::printf("random int64_t keys: ns/op\n");
+    std::printf("%9s | %-28s | %-28s | %-28s | %-28s | %-28s\n", "", "BinarySearchTree", "CompactBinarySearchTree", "ParentFreeBinarySearchTree", "BTree", "std::multiset");
+    std::printf("%9s", "n");
+    for (int i = 0; i < 5; ++i) {
+        std::printf(" | %8s %8s %10s", "insert", "find", "lower_bnd");
+    }
+    std::printf("\n");
+
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::int64_t> inserts(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = 2 * i;
+        }
+        std::vector<std::int64_t> queries = inserts;
+        shuffle(inserts, state);
+        shuffle(queries, state);
+
+        LookupSample samples[] = {
+                measure<BinarySearchTree<std::int64_t>>(inserts, queries, false),
+                measure<CompactBinarySearchTree<std::int64_t>>(inserts, queries, true),
+                measure<ParentFreeBinarySearchTree<std::int64_t>>(inserts, queries, true),
+                measure<BTree<std::int64_t>>(inserts, queries, true),
+                measure<std::multiset<std::int64_t>>(inserts, queries, true),
+        };
+        std::printf("%9zu", n);
+        for (const LookupSample& sample : samples) {
+            std::printf(" | %8.1f %8.1f", sample.insert_ns, sample.find_ns);
+            if (sample.lower_bound_measured) {
+                std::printf(" %10.1f", sample.lower_bound_ns);
+            } else {
+                std::printf(" %10s", "-");
+            }
+        }
+        std::printf("\n");
+    }
+    std::printf("\n");
+}
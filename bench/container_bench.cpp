@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+enum class Workload { kRandom, kSorted, kReverse, kZipf };
+
+enum Operation { kInsert, kFind, kLowerBound, kIterate, kErase, kOperationCount };
+
+const char* const kOperationNames[kOperationCount] = {"insert", "find", "lower_bound", "iterate", "erase"};
+
+const char* workload_name(Workload workload) {
+    switch (workload) {
+        case Workload::kRandom:
+            return "random";
+        case Workload::kSorted:
+            return "sorted";
+        case Workload::kReverse:
+            return "reverse-sorted";
+        case Workload::kZipf:
+            return "zipf";
+    }
+    return "";
+}
+
+// The unbalanced tree turns into a list on ordered input and into long chains of equal keys on skewed input,
+// so those workloads stop at a size that still finishes in seconds.
+std::size_t bst_size_limit(Workload workload) {
+    switch (workload) {
+        case Workload::kSorted:
+        case Workload::kReverse:
+            return 10000;
+        case Workload::kZipf:
+            return 100000;
+        default:
+            return std::numeric_limits<std::size_t>::max();
+    }
+}
+
+// Stored keys are even, so probing value + 1 exercises lower_bound between keys.
+template<class T>
+T make_key(std::uint64_t value) {
+    return static_cast<T>(value);
+}
+
+template<>
+std::string make_key<std::string>(std::uint64_t value) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%012llu", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+struct Plan {
+    std::vector<std::uint64_t> inserts;
+    std::vector<std::uint64_t> queries;
+};
+
+Plan make_plan(Workload workload, std::size_t n) {
+    std::uint64_t state = 0x9E3779B97F4A7C15ull ^ (n * 31 + static_cast<std::uint64_t>(workload));
+    Plan plan;
+    plan.inserts.resize(n);
+    plan.queries.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        plan.inserts[i] = 2 * i;
+        plan.queries[i] = 2 * i;
+    }
+    switch (workload) {
+        case Workload::kRandom:
+            shuffle(plan.inserts, state);
+            shuffle(plan.queries, state);
+            break;
+        case Workload::kSorted:
+            break;
+        case Workload::kReverse:
+            std::reverse(plan.inserts.begin(), plan.inserts.end());
+            std::reverse(plan.queries.begin(), plan.queries.end());
+            break;
+        case Workload::kZipf: {
+            ZipfGenerator zipf(n, state);
+            for (std::size_t i = 0; i < n; ++i) {
+                plan.inserts[i] = zipf.next();
+                plan.queries[i] = zipf.next();
+            }
+            break;
+        }
+    }
+    return plan;
+}
+
+struct Sample {
+    bool measured = false;
+    double ns = 0;
+    double comparisons = 0;
+    double allocations = 0;
+};
+
+class Probe {
+public:
+    Probe() : comparisons_(comparison_count), allocations_(allocation_count()) {}
+
+    Sample finish(std::size_t operations) const {
+        double ns = stopwatch_.elapsed_ns();
+        double count = static_cast<double>(std::max<std::size_t>(operations, 1));
+        return {true, ns / count, static_cast<double>(comparison_count - comparisons_) / count, static_cast<double>(allocation_count() - allocations_) / count};
+    }
+
+private:
+    std::uint64_t comparisons_;
+    std::uint64_t allocations_;
+    Stopwatch stopwatch_;
+};
+
+template<class Container>
+constexpr bool kLinearLowerBound = false;
+
+template<class Key>
+constexpr bool kLinearLowerBound<BinarySearchTree<Key>> = true;
+
+template<class Container, class T>
+std::array<Sample, kOperationCount> measure(const Plan& plan) {
+    typedef Counted<T> key_type;
+    std::vector<key_type> inserts;
+    std::vector<key_type> queries;
+    std::vector<key_type> probes;
+    for (std::uint64_t value : plan.inserts) {
+        inserts.push_back({make_key<T>(value)});
+    }
+    for (std::uint64_t value : plan.queries) {
+        queries.push_back({make_key<T>(value)});
+        probes.push_back({make_key<T>(value + 1)});
+    }
+
+    // BinarySearchTree::lower_bound walks successors from the leftmost candidate, so it gets fewer probes.
+    std::size_t lower_bound_count = probes.size();
+    if (kLinearLowerBound<Container>) {
+        lower_bound_count = std::min(lower_bound_count, std::max<std::size_t>(100000000 / std::max<std::size_t>(probes.size(), 1), 1));
+    }
+
+    std::array<Sample, kOperationCount> samples;
+    Container container;
+    {
+        Probe probe;
+        for (const key_type& key : inserts) {
+            container.insert(key);
+        }
+        samples[kInsert] = probe.finish(inserts.size());
+    }
+    {
+        std::size_t found = 0;
+        Probe probe;
+        for (const key_type& key : queries) {
+            found += container.contains(key);
+        }
+        samples[kFind] = probe.finish(queries.size());
+        do_not_optimize(found);
+    }
+    {
+        Probe probe;
+        for (std::size_t i = 0; i < lower_bound_count; ++i) {
+            auto it = container.lower_bound(probes[i]);
+            do_not_optimize(it);
+        }
+        samples[kLowerBound] = probe.finish(lower_bound_count);
+    }
+    {
+        std::size_t visited = 0;
+        Probe probe;
+        auto last = container.end();
+        for (auto it = container.begin(); it != last; ++it) {
+            do_not_optimize(*it);
+            ++visited;
+        }
+        samples[kIterate] = probe.finish(visited);
+    }
+    {
+        Probe probe;
+        for (const key_type& key : queries) {
+            container.erase(key);
+        }
+        samples[kErase] = probe.finish(queries.size());
+    }
+    return samples;
+}
+
+void print_sample(const Sample& sample) {
+    if (!sample.measured) {
+        std::printf(" | %10s %8s %8s", "-", "-", "-");
+        return;
+    }
+    std::printf(" | %10.1f %8.1f %8.2f", sample.ns, sample.comparisons, sample.allocations);
+}
+
+template<class T>
+void run_key_type(Workload workload, const char* key_name, std::size_t max_size) {
+    std::printf("%s / %s\n", workload_name(workload), key_name);
+    std::printf("%9s %-12s | %-28s | %-28s | %-28s\n", "", "", "BinarySearchTree", "std::set", "std::multiset");
+    std::printf("%9s %-12s", "n", "operation");
+    for (int i = 0; i < 3; ++i) {
+        std::printf(" | %10s %8s %8s", "ns/op", "cmp/op", "alloc/op");
+    }
+    std::printf("\n");
+
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        Plan plan = make_plan(workload, n);
+        std::array<Sample, kOperationCount> tree_samples {};
+        if (n <= bst_size_limit(workload)) {
+            tree_samples = measure<BinarySearchTree<Counted<T>>, T>(plan);
+        }
+        std::array<Sample, kOperationCount> set_samples = measure<std::set<Counted<T>>, T>(plan);
+        std::array<Sample, kOperationCount> multiset_samples = measure<std::multiset<Counted<T>>, T>(plan);
+
+        for (int operation = 0; operation < kOperationCount; ++operation) {
+            std::printf("%9zu %-12s", n, kOperationNames[operation]);
+            print_sample(tree_samples[operation]);
+            print_sample(set_samples[operation]);
+            print_sample(multiset_samples[operation]);
+            std::printf("\n");
+        }
+    }
+    std::printf("\n");
+}
+
+}
+
+void run_container_bench(std::size_t max_size) {
+    for (Workload workload : {Workload::kRandom, Workload::kSorted, Workload::kReverse, Workload::kZipf}) {
+        run_key_type<int>(workload, "int", max_size);
+        run_key_type<std::uint64_t>(workload, "uint64_t", max_size);
+        run_key_type<std::string>(workload, "std::string", max_size);
+    }
+}
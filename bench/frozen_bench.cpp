@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+template<class Lookup>
+double time_lookups(const std::vector<std::int64_t>& queries, Lookup lookup) {
+    std::size_t found = 0;
+    Stopwatch stopwatch;
+    for (std::int64_t key : queries) {
+        found += lookup(key);
+    }
+    double ns = stopwatch.elapsed_ns() / static_cast<double>(queries.size());
+    do_not_optimize(found);
+    return ns;
+}
+
+template<class Tree>
+double time_scan(const Tree& tree) {
+    std::int64_t sum = 0;
+    Stopwatch stopwatch;
+    auto last = tree.end();
+    for (auto it = tree.begin(); it != last; ++it) {
+        sum += *it;
+    }
+    double ns = stopwatch.elapsed_ns() / static_cast<double>(tree.size());
+    do_not_optimize(sum);
+    return ns;
+}
+
+}
+
+// Keys are inserted in random order, so find_node walks a tree of typical random shape; half of the
+// queries miss. The compact columns repeat find_node and an in-order scan after compact().
+void run_frozen_bench(std::size_t max_size) {
+    std::printf("random int64_t lookups: ns/op\n");
+    std::printf("%9s | %12s %12s | %12s %12s | %12s %12s | %12s %12s | %12s\n", "n", "find_node", "compact find", "scan", "compact scan", "frozen find", "frozen lower", "vEB find", "vEB lower", "sorted array");
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::int64_t> inserts(n);
+        std::vector<std::int64_t> queries(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = static_cast<std::int64_t>(2 * i);
+            queries[i] = static_cast<std::int64_t>(i);
+        }
+        shuffle(inserts, state);
+        shuffle(queries, state);
+
+        BinarySearchTree<std::int64_t> tree;
+        for (std::int64_t key : inserts) {
+            tree.insert(key);
+        }
+        FrozenBinarySearchTree<std::int64_t> frozen = tree.freeze();
+        VebBinarySearchTree<std::int64_t> veb = tree.freeze(tag<VanEmdeBoas>{});
+        std::vector<std::int64_t> sorted(frozen.begin(), frozen.end());
+
+        double tree_ns = time_lookups(queries, [&tree](std::int64_t key) { return tree.contains(key); });
+        double frozen_ns = time_lookups(queries, [&frozen](std::int64_t key) { return frozen.contains(key); });
+        double frozen_lower_ns = time_lookups(queries, [&frozen](std::int64_t key) { return frozen.lower_bound(key) != frozen.end(); });
+        double veb_ns = time_lookups(queries, [&veb](std::int64_t key) { return veb.contains(key); });
+        double veb_lower_ns = time_lookups(queries, [&veb](std::int64_t key) { return veb.lower_bound(key) != veb.end(); });
+        double sorted_ns = time_lookups(queries, [&sorted](std::int64_t key) { return std::binary_search(sorted.begin(), sorted.end(), key); });
+        double scan_ns = time_scan(tree);
+        tree.compact();
+        double compact_ns = time_lookups(queries, [&tree](std::int64_t key) { return tree.contains(key); });
+        double compact_scan_ns = time_scan(tree);
+        std::printf("%9zu | %12.1f %12.1f | %12.1f %12.1f | %12.1f %12.1f | %12.1f %12.1f | %12.1f\n", n, tree_ns, compact_ns, scan_ns, compact_scan_ns, frozen_ns, frozen_lower_ns, veb_ns, veb_lower_ns, sorted_ns);
+    }
+    std::printf("\n");
+}
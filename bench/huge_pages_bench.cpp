@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+struct LookupResult {
+    double ns;
+    // -1 without a TLB counter.
+    double tlb_misses;
+};
+
+LookupResult time_lookups(const BinarySearchTree<std::int64_t>& tree, const std::vector<std::int64_t>& queries, TlbMissCounter& counter) {
+    std::size_t found = 0;
+    counter.start();
+    Stopwatch stopwatch;
+    for (std::int64_t key : queries) {
+        found += tree.contains(key);
+    }
+    double ns = stopwatch.elapsed_ns();
+    long long misses = counter.read();
+    do_not_optimize(found);
+    double count = static_cast<double>(queries.size());
+    return {ns / count, misses < 0 ? -1.0 : static_cast<double>(misses) / count};
+}
+
+const char* backing_name(const BinarySearchTree<std::int64_t>& tree) {
+    if (tree.mapped_bytes(PageBacking::Explicit) != 0) {
+        return "hugetlb";
+    }
+    if (tree.mapped_bytes(PageBacking::Transparent) != 0) {
+        return "thp";
+    }
+    return "small";
+}
+
+}
+
+// The same random keys go into a tree allocating nodes one by one and into one with set_huge_pages();
+// half of the queries miss. TLB columns are data TLB load misses per lookup, "-" where perf_event_open
+// is not permitted. The backing column says what the kernel granted the huge page tree.
+void run_huge_pages_bench(std::size_t max_size) {
+    TlbMissCounter counter;
+    std::printf("random int64_t lookups with huge page node slabs\n");
+    std::printf("%9s | %-21s | %-21s | %-21s | %8s\n", "", "malloc nodes", "huge page slabs", "huge pages + compact", "");
+    std::printf("%9s | %10s %10s | %10s %10s | %10s %10s | %8s\n", "n", "ns/op", "TLB/op", "ns/op", "TLB/op", "ns/op", "TLB/op", "backing");
+    auto print_result = [](const LookupResult& result) {
+        if (result.tlb_misses < 0) {
+            std::printf(" | %10.1f %10s", result.ns, "-");
+        } else {
+            std::printf(" | %10.1f %10.2f", result.ns, result.tlb_misses);
+        }
+    };
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::int64_t> inserts(n);
+        std::vector<std::int64_t> queries(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = static_cast<std::int64_t>(2 * i);
+            queries[i] = static_cast<std::int64_t>(i);
+        }
+        shuffle(inserts, state);
+        shuffle(queries, state);
+
+        LookupResult malloc_result;
+        {
+            BinarySearchTree<std::int64_t> tree;
+            for (std::int64_t key : inserts) {
+                tree.insert(key);
+            }
+            malloc_result = time_lookups(tree, queries, counter);
+        }
+
+        BinarySearchTree<std::int64_t> tree;
+        tree.set_huge_pages();
+        for (std::int64_t key : inserts) {
+            tree.insert(key);
+        }
+        LookupResult huge_result = time_lookups(tree, queries, counter);
+        tree.compact();
+        LookupResult compact_result = time_lookups(tree, queries, counter);
+
+        std::printf("%9zu", n);
+        print_result(malloc_result);
+        print_result(huge_result);
+        print_result(compact_result);
+        std::printf(" | %8s\n", backing_name(tree));
+    }
+    std::printf("\n");
+}
@@ -0,0 +1,48 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+void run_insert_batch_bench(std::size_t max_size) {
+    std::printf("insert_batch vs sequential insert (random keys into a tree of equal size, %u threads)\n", std::thread::hardware_concurrency());
+    std::printf("%12s %16s %16s %16s %10s\n", "batch", "sequential ns/op", "reserved ns/op", "batch ns/op", "speedup");
+    for (std::size_t n = 10000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull + n;
+        std::vector<int> base(n);
+        std::vector<int> batch(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            base[i] = static_cast<int>(next_random(state));
+            batch[i] = static_cast<int>(next_random(state));
+        }
+
+        BinarySearchTree<int> sequential;
+        sequential.insert_batch(base);
+        Stopwatch sequential_timer;
+        sequential.insert(batch.begin(), batch.end());
+        double sequential_ns = sequential_timer.elapsed_ns();
+
+        BinarySearchTree<int> reserved;
+        reserved.insert_batch(base);
+        reserved.reserve(2 * n);
+        std::uint64_t allocations = allocation_count();
+        Stopwatch reserved_timer;
+        reserved.insert(batch.begin(), batch.end());
+        double reserved_ns = reserved_timer.elapsed_ns();
+        if (allocation_count() != allocations) {
+            std::printf("unexpected allocations after reserve()\n");
+        }
+
+        BinarySearchTree<int> batched;
+        batched.insert_batch(base);
+        Stopwatch batch_timer;
+        batched.insert_batch(batch);
+        double batch_ns = batch_timer.elapsed_ns();
+
+        do_not_optimize(sequential.size() + reserved.size() + batched.size());
+        std::printf("%12zu %16.1f %16.1f %16.1f %9.2fx\n", n, sequential_ns / n, reserved_ns / n, batch_ns / n, sequential_ns / batch_ns);
+    }
+    std::printf("\n");
+}
@@ -0,0 +1,54 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "bench.h"
+
+namespace {
+
+struct Section {
+    const char* name;
+    void (*run)(std::size_t max_size);
+};
+
+const Section kSections[] = {
+        {"containers", run_container_bench},
+        {"insert_batch", run_insert_batch_bench},
+        {"serialization", run_serialization_bench},
+        {"splay", run_splay_bench},
+        {"btree", run_btree_bench},
+        {"frozen", run_frozen_bench},
+        {"projected", run_projected_bench},
+        {"string", run_string_bench},
+        {"huge_pages", run_huge_pages_bench},
+        {"multiplicity", run_multiplicity_bench},
+};
+
+}
+
+// Usage: binary_search_tree_bench [--max-size N] [--section NAME]...
+int main(int argc, char** argv) {
+    std::size_t max_size = 1000000;
+    const char* selected[sizeof(kSections) / sizeof(kSections[0])] = {};
+    std::size_t selected_count = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--section") == 0 && i + 1 < argc && selected_count < sizeof(selected) / sizeof(selected[0])) {
+            selected[selected_count++] = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--max-size N] [--section containers|insert_batch|serialization|splay|btree|frozen|projected|string|huge_pages|multiplicity]...\n";
+            return 1;
+        }
+    }
+
+    for (const Section& section : kSections) {
+        bool run = selected_count == 0;
+        for (std::size_t i = 0; i < selected_count; ++i) {
+            run = run || std::strcmp(selected[i], section.name) == 0;
+        }
+        if (run) {
+            section.run(max_size);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+#include <lib/MultiplicityBinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+constexpr std::size_t kDistinctKeys = 1000;
+
+struct Timings {
+    double insert_ns;
+    double count_ns;
+    double erase_ns;
+};
+
+// Inserts every event, counts every distinct key, then erases every distinct key; count and erase are
+// timed per key.
+template<class Tree>
+Timings time_tree(const std::vector<std::int64_t>& events, const std::vector<std::int64_t>& keys) {
+    Tree tree;
+    Stopwatch insert_timer;
+    for (std::int64_t key : events) {
+        tree.insert(key);
+    }
+    double insert_ns = insert_timer.elapsed_ns() / static_cast<double>(events.size());
+
+    std::size_t total = 0;
+    Stopwatch count_timer;
+    for (std::int64_t key : keys) {
+        total += tree.count(key);
+    }
+    double count_ns = count_timer.elapsed_ns() / static_cast<double>(keys.size());
+    do_not_optimize(total);
+
+    Stopwatch erase_timer;
+    for (std::int64_t key : keys) {
+        total += tree.erase(key);
+    }
+    double erase_ns = erase_timer.elapsed_ns() / static_cast<double>(keys.size());
+    do_not_optimize(total);
+    return {insert_ns, count_ns, erase_ns};
+}
+
+void print_timings(const Timings& timings) {
+    std::printf(" | %10.1f %10.1f %10.1f", timings.insert_ns, timings.count_ns, timings.erase_ns);
+}
+
+}
+
+// n events drawn uniformly from 1000 keys. BinarySearchTree keeps one node per event on the left
+// spine of its key, so its count and erase(key) grow with n / 1000; past 100000 events it is skipped.
+void run_multiplicity_bench(std::size_t max_size) {
+    std::printf("events over %zu distinct int64_t keys: insert ns/event, count and erase ns/key\n", kDistinctKeys);
+    std::printf("%9s | %-32s | %-32s | %-32s\n", "", "BinarySearchTree", "std::multiset", "MultiplicityBinarySearchTree");
+    std::printf("%9s | %10s %10s %10s | %10s %10s %10s | %10s %10s %10s\n", "n", "insert", "count", "erase", "insert", "count", "erase", "insert", "count", "erase");
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::int64_t> keys(kDistinctKeys);
+        for (std::size_t i = 0; i < kDistinctKeys; ++i) {
+            keys[i] = static_cast<std::int64_t>(i);
+        }
+        std::vector<std::int64_t> events(n);
+        for (std::int64_t& key : events) {
+            key = static_cast<std::int64_t>(next_random(state) % kDistinctKeys);
+        }
+        shuffle(keys, state);
+
+        std::printf("%9zu", n);
+        if (n <= 100000) {
+            print_timings(time_tree<BinarySearchTree<std::int64_t>>(events, keys));
+        } else {
+            std::printf(" | %10s %10s %10s", "-", "-", "-");
+        }
+        print_timings(time_tree<std::multiset<std::int64_t>>(events, keys));
+        print_timings(time_tree<MultiplicityBinarySearchTree<std::int64_t>>(events, keys));
+        std::printf("\n");
+    }
+    std::printf("\n");
+}
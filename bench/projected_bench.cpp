@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+#include <lib/ProjectedBinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+// Four cache lines of which a comparison reads eight bytes.
+struct Record {
+    std::int64_t id;
+    char payload[248];
+};
+
+bool operator<(const Record& lhs, const Record& rhs) {
+    return lhs.id < rhs.id;
+}
+
+bool operator!=(const Record& lhs, const Record& rhs) {
+    return lhs.id != rhs.id;
+}
+
+template<class Lookup>
+double time_lookups(const std::vector<std::int64_t>& queries, Lookup lookup) {
+    std::size_t found = 0;
+    Stopwatch stopwatch;
+    for (std::int64_t key : queries) {
+        found += lookup(key);
+    }
+    double ns = stopwatch.elapsed_ns() / static_cast<double>(queries.size());
+    do_not_optimize(found);
+    return ns;
+}
+
+}
+
+// The same records in random order go into a BinarySearchTree keeping them in its nodes and into a
+// ProjectedBinarySearchTree keeping only the id inline; half of the queries miss.
+void run_projected_bench(std::size_t max_size) {
+    std::printf("256-byte records by int64_t id: ns/op\n");
+    std::printf("%9s | %-21s | %-21s\n", "", "BinarySearchTree", "ProjectedBinarySearchTree");
+    std::printf("%9s | %10s %10s | %10s %10s\n", "n", "insert", "find", "insert", "find");
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::int64_t> inserts(n);
+        std::vector<std::int64_t> queries(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = static_cast<std::int64_t>(2 * i);
+            queries[i] = static_cast<std::int64_t>(i);
+        }
+        shuffle(inserts, state);
+        shuffle(queries, state);
+
+        BinarySearchTree<Record> tree;
+        Stopwatch tree_timer;
+        for (std::int64_t id : inserts) {
+            tree.insert(Record{id, {}});
+        }
+        double tree_insert_ns = tree_timer.elapsed_ns() / static_cast<double>(n);
+        double tree_find_ns = time_lookups(queries, [&tree](std::int64_t id) { return tree.contains(Record{id, {}}); });
+
+        ProjectedBinarySearchTree<Record, project_member<&Record::id>> projected;
+        Stopwatch projected_timer;
+        for (std::int64_t id : inserts) {
+            projected.insert(Record{id, {}});
+        }
+        double projected_insert_ns = projected_timer.elapsed_ns() / static_cast<double>(n);
+        double projected_find_ns = time_lookups(queries, [&projected](std::int64_t id) { return projected.contains(id); });
+
+        std::printf("%9zu | %10.1f %10.1f | %10.1f %10.1f\n", n, tree_insert_ns, tree_find_ns, projected_insert_ns, projected_find_ns);
+    }
+    std::printf("\n");
+}
@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+void run_serialization_bench(std::size_t max_size) {
+    std::printf("save/load throughput (random int keys; reload compared with the range constructor over unsorted keys)\n");
+    std::printf("%12s %12s %12s %12s %18s\n", "keys", "MB", "save MB/s", "load MB/s", "range ctor MB/s");
+    for (std::size_t n = 100000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x2545F4914F6CDD1Dull + n;
+        std::vector<int> keys(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<int>(next_random(state));
+        }
+        BinarySearchTree<int> bst;
+        bst.insert_batch(keys);
+
+        std::vector<std::byte> buffer(bst.serialized_size());
+        double megabytes = static_cast<double>(buffer.size()) / (1 << 20);
+
+        Stopwatch save_timer;
+        bst.save(buffer);
+        double save_ns = save_timer.elapsed_ns();
+
+        BinarySearchTree<int> loaded;
+        Stopwatch load_timer;
+        loaded.load(buffer);
+        double load_ns = load_timer.elapsed_ns();
+
+        Stopwatch range_timer;
+        BinarySearchTree<int> rebuilt(keys.begin(), keys.end());
+        double range_ns = range_timer.elapsed_ns();
+
+        do_not_optimize(loaded.size() + rebuilt.size());
+        std::printf("%12zu %12.2f %12.1f %12.1f %18.1f\n", n, megabytes, megabytes / save_ns * 1e9, megabytes / load_ns * 1e9, megabytes / range_ns * 1e9);
+    }
+    std::printf("\n");
+}
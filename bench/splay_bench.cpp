@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+template<class Balance>
+using CountedTree = BinarySearchTree<std::uint64_t, InOrder, std::less<std::uint64_t>, std::allocator<std::uint64_t>, CountingInstrumentation, Balance>;
+
+struct LookupSample {
+    double ns = 0;
+    double visits = 0;
+    double comparisons = 0;
+    double rotations = 0;
+};
+
+// Keys are inserted in random order so the unbalanced tree starts from a typical O(log n) shape;
+// the lookups then follow a Zipf(0.99) distribution over the same keys.
+template<class Balance>
+LookupSample measure(const std::vector<std::uint64_t>& inserts, const std::vector<std::uint64_t>& queries) {
+    CountedTree<Balance> tree;
+    for (std::uint64_t key : inserts) {
+        tree.insert(key);
+    }
+    tree.reset_stats();
+
+    std::size_t found = 0;
+    Stopwatch stopwatch;
+    for (std::uint64_t key : queries) {
+        found += tree.contains(key);
+    }
+    double ns = stopwatch.elapsed_ns();
+    do_not_optimize(found);
+
+    InstrumentationStats stats = tree.stats();
+    double count = static_cast<double>(queries.size());
+    return {ns / count, stats.visits_per_descent(), static_cast<double>(stats.comparisons) / count, static_cast<double>(stats.rotations) / count};
+}
+
+}
+
+void run_splay_bench(std::size_t max_size) {
+    std::printf("zipf lookups: Unbalanced vs Splay\n");
+    std::printf("%9s | %10s %8s %8s | %10s %8s %8s %8s\n", "n", "ns/op", "visit/op", "cmp/op", "ns/op", "visit/op", "cmp/op", "rot/op");
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::uint64_t> inserts(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = 2 * i;
+        }
+        shuffle(inserts, state);
+        ZipfGenerator zipf(n, state);
+        std::vector<std::uint64_t> queries(4 * n);
+        for (std::uint64_t& query : queries) {
+            query = zipf.next();
+        }
+
+        LookupSample plain = measure<Unbalanced>(inserts, queries);
+        LookupSample splay = measure<Splay>(inserts, queries);
+        std::printf("%9zu | %10.1f %8.2f %8.2f | %10.1f %8.2f %8.2f %8.2f\n", n, plain.ns, plain.visits, plain.comparisons, splay.ns, splay.visits, splay.comparisons, splay.rotations);
+    }
+    std::printf("\n");
+}
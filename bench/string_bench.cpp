@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <lib/BinarySearchTree.h>
+#include <lib/StringBinarySearchTree.h>
+
+#include "bench.h"
+
+namespace {
+
+// Random lowercase words of 6 to 14 letters: inline in StringNode, prefixes rarely tie.
+std::string make_word(std::uint64_t& state) {
+    std::string key(6 + next_random(state) % 9, 'a');
+    for (char& c : key) {
+        c = static_cast<char>('a' + next_random(state) % 26);
+    }
+    return key;
+}
+
+// Paths under one 26-byte directory: every prefix ties and the keys go to the arena.
+std::string make_path(std::uint64_t& state) {
+    static const char digits[] = "0123456789abcdef";
+    std::string key = "/var/lib/store/objects/ab/";
+    for (int i = 0; i < 16; ++i) {
+        key.push_back(digits[next_random(state) % 16]);
+    }
+    return key;
+}
+
+template<class Tree>
+std::pair<double, double> time_tree(const std::vector<std::string>& inserts, const std::vector<std::string>& queries) {
+    Tree tree;
+    Stopwatch insert_timer;
+    for (const std::string& key : inserts) {
+        tree.insert(key);
+    }
+    double insert_ns = insert_timer.elapsed_ns() / static_cast<double>(inserts.size());
+
+    std::size_t found = 0;
+    Stopwatch find_timer;
+    for (const std::string& key : queries) {
+        found += tree.contains(key);
+    }
+    double find_ns = find_timer.elapsed_ns() / static_cast<double>(queries.size());
+    do_not_optimize(found);
+    return {insert_ns, find_ns};
+}
+
+void run_shape(const char* title, std::string (*make_key)(std::uint64_t&), std::size_t max_size) {
+    std::printf("%s: ns/op\n", title);
+    std::printf("%9s | %-21s | %-21s\n", "", "BinarySearchTree", "StringBinarySearchTree");
+    std::printf("%9s | %10s %10s | %10s %10s\n", "n", "insert", "find", "insert", "find");
+    for (std::size_t n = 1000; n <= max_size; n *= 10) {
+        std::uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+        std::vector<std::string> inserts(n);
+        std::vector<std::string> queries(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            inserts[i] = make_key(state);
+        }
+        // Half of the queries hit.
+        for (std::size_t i = 0; i < n; ++i) {
+            queries[i] = i % 2 == 0 ? inserts[next_random(state) % n] : make_key(state);
+        }
+
+        auto [tree_insert_ns, tree_find_ns] = time_tree<BinarySearchTree<std::string>>(inserts, queries);
+        auto [string_insert_ns, string_find_ns] = time_tree<StringBinarySearchTree<>>(inserts, queries);
+        std::printf("%9zu | %10.1f %10.1f | %10.1f %10.1f\n", n, tree_insert_ns, tree_find_ns, string_insert_ns, string_find_ns);
+    }
+    std::printf("\n");
+}
+
+}
+
+// std::string keys in a BinarySearchTree against StringBinarySearchTree's cached prefixes and inline
+// keys, for keys the prefix separates and for keys it never does.
+void run_string_bench(std::size_t max_size) {
+    run_shape("short random words", make_word, max_size);
+    run_shape("42-byte paths sharing a 26-byte prefix", make_path, max_size);
+}
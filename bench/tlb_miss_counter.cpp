@@ -0,0 +1,52 @@
+#include "bench.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+TlbMissCounter::TlbMissCounter() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+}
+
+TlbMissCounter::~TlbMissCounter() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+bool TlbMissCounter::available() const {
+    return fd_ >= 0;
+}
+
+void TlbMissCounter::start() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+long long TlbMissCounter::read() const {
+#ifdef __linux__
+    long long count = 0;
+    if (fd_ >= 0 && ::read(fd_, &count, sizeof(count)) == sizeof(count)) {
+        return count;
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,794 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "KeySearch.h"
+
+// Target size of a node; nodes are also aligned to a cache line so each one spans exactly
+// kBTreeNodeBytes / 64 lines.
+inline constexpr std::size_t kBTreeNodeBytes = 256;
+
+template<typename T>
+struct BTreeInnerNode;
+
+template<typename T>
+struct BTreeNodeBase {
+    explicit BTreeNodeBase(bool leaf) : leaf_(leaf) {}
+
+    BTreeInnerNode<T>* parent_ = nullptr;
+    unsigned short count_ = 0;
+    const bool leaf_;
+};
+
+template<typename T>
+struct alignas(64) BTreeLeafNode : BTreeNodeBase<T> {
+    static constexpr unsigned short kCapacity = std::max<std::size_t>(4, (kBTreeNodeBytes - sizeof(BTreeNodeBase<T>) - 2 * sizeof(void*)) / sizeof(T));
+
+    BTreeLeafNode() : BTreeNodeBase<T>(true) {}
+
+    BTreeLeafNode<T>* prev_ = nullptr;
+    BTreeLeafNode<T>* next_ = nullptr;
+    T keys_[kCapacity];
+};
+
+// keys_[i] separates children_[i] and children_[i + 1]: every key under the left child compares
+// less than or equal to it and every key under the right child greater than or equal to it.
+template<typename T>
+struct alignas(64) BTreeInnerNode : BTreeNodeBase<T> {
+    static constexpr unsigned short kCapacity = std::max<std::size_t>(3, (kBTreeNodeBytes - sizeof(BTreeNodeBase<T>) - sizeof(void*)) / (sizeof(T) + sizeof(void*)));
+
+    BTreeInnerNode() : BTreeNodeBase<T>(false) {}
+
+    T keys_[kCapacity];
+    BTreeNodeBase<T>* children_[kCapacity + 1];
+};
+
+// B+ tree multiset with the lookup and modification interface of BinarySearchTree. Keys live in leaves
+// linked into a list, so iteration never climbs the tree. Unlike BinarySearchTree, insert and erase
+// invalidate all iterators, including end(). Keys must be default constructible and move assignable.
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class BTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Allocator allocator_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef BTreeNodeBase<Key> node_type;
+    typedef BTreeLeafNode<Key> leaf_type;
+    typedef BTreeInnerNode<Key> inner_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    BTree() = default;
+    explicit BTree(const Allocator& alloc);
+    template<class InputIt>
+    BTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    BTree(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+    BTree(const BTree<Key, Compare, Allocator>& other);
+    BTree(BTree<Key, Compare, Allocator>&& other) noexcept;
+    ~BTree();
+
+    BTree<Key, Compare, Allocator>& operator=(const BTree<Key, Compare, Allocator>& other);
+    BTree<Key, Compare, Allocator>& operator=(BTree<Key, Compare, Allocator>&& other) noexcept;
+    BTree<Key, Compare, Allocator>& operator=(std::initializer_list<value_type> ilist);
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] size_type max_size() const noexcept;
+    // Number of levels; every leaf is at the same depth.
+    [[nodiscard]] size_type height() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    iterator insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const Key& key);
+    void swap(BTree<Key, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+    bool operator==(const BTree<Key, Compare, Allocator>& rhs) const;
+    bool operator!=(const BTree<Key, Compare, Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<leaf_type> leaf_allocator;
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<inner_type> inner_allocator;
+    typedef std::allocator_traits<leaf_allocator> leaf_traits;
+    typedef std::allocator_traits<inner_allocator> inner_traits;
+
+    static constexpr unsigned short kMinLeafCount = leaf_type::kCapacity / 2;
+    static constexpr unsigned short kMinInnerCount = inner_type::kCapacity / 2;
+
+    node_type* root_ = nullptr;
+    leaf_type* leftmost_ = nullptr;
+    leaf_type* rightmost_ = nullptr;
+    size_type size_ = 0;
+    size_type height_ = 0;
+    [[no_unique_address]] leaf_allocator leaf_allocator_;
+    [[no_unique_address]] inner_allocator inner_allocator_;
+
+    static unsigned short lower_index(const Key* keys, unsigned short count, const Key& key);
+    static unsigned short upper_index(const Key* keys, unsigned short count, const Key& key);
+    static unsigned short child_index(const inner_type* parent, const node_type* child);
+    static const_iterator make_iterator(const leaf_type* leaf, unsigned short position);
+
+    leaf_type* make_leaf();
+    inner_type* make_inner();
+    void destroy(node_type* node);
+    node_type* clone(const node_type* node, inner_type* parent, leaf_type*& previous);
+
+    void split_leaf(leaf_type* leaf);
+    void insert_into_parent(node_type* left, const Key& separator, node_type* right);
+    void insert_into_inner(inner_type* inner, unsigned short index, const Key& separator, node_type* right);
+    void merge_leaves(leaf_type* left, leaf_type* right, unsigned short separator);
+    void merge_inners(inner_type* left, inner_type* right, unsigned short separator);
+    void erase_from_inner(inner_type* inner, unsigned short index);
+};
+
+// Points at a key slot of a leaf. Positions past the last key of a leaf are normalised to the first key
+// of the next leaf, so only end() has position == count_.
+template<class Key, class Compare, class Allocator>
+class BTree<Key, Compare, Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const leaf_type* leaf, unsigned short position) : leaf_(leaf), position_(position) {}
+
+    reference operator*() const { return leaf_->keys_[position_]; }
+    pointer operator->() const { return &leaf_->keys_[position_]; }
+
+    const_iterator& operator++() {
+        if (++position_ == leaf_->count_ && leaf_->next_ != nullptr) {
+            leaf_ = leaf_->next_;
+            position_ = 0;
+        }
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        if (position_ == 0) {
+            leaf_ = leaf_->prev_;
+            position_ = leaf_->count_;
+        }
+        --position_;
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return leaf_ == other.leaf_ && position_ == other.position_; }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    const leaf_type* get_leaf() const { return leaf_; }
+    unsigned short position() const { return position_; }
+
+private:
+    const leaf_type* leaf_ = nullptr;
+    unsigned short position_ = 0;
+};
+
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::BTree(const Allocator& alloc) : leaf_allocator_(alloc), inner_allocator_(alloc) {}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+BTree<Key, Compare, Allocator>::BTree(InputIt first, InputIt last, const Allocator& alloc) : BTree<Key, Compare, Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::BTree(std::initializer_list<value_type> init, const Allocator& alloc) : BTree<Key, Compare, Allocator>(init.begin(), init.end(), alloc) {}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::BTree(const BTree<Key, Compare, Allocator>& other)
+        : leaf_allocator_(leaf_traits::select_on_container_copy_construction(other.leaf_allocator_)),
+          inner_allocator_(inner_traits::select_on_container_copy_construction(other.inner_allocator_)) {
+    if (other.root_ == nullptr) {
+        return;
+    }
+    leaf_type* previous = nullptr;
+    root_ = clone(other.root_, nullptr, previous);
+    rightmost_ = previous;
+    size_ = other.size_;
+    height_ = other.height_;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::BTree(BTree<Key, Compare, Allocator>&& other) noexcept
+        : leaf_allocator_(other.leaf_allocator_), inner_allocator_(other.inner_allocator_) {
+    swap(other);
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::~BTree() {
+    clear();
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>& BTree<Key, Compare, Allocator>::operator=(const BTree<Key, Compare, Allocator>& other) {
+    if (this != &other) {
+        BTree<Key, Compare, Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>& BTree<Key, Compare, Allocator>::operator=(BTree<Key, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>& BTree<Key, Compare, Allocator>::operator=(std::initializer_list<value_type> ilist) {
+    clear();
+    insert(ilist);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::allocator_type BTree<Key, Compare, Allocator>::get_allocator() const noexcept {
+    return allocator_type(leaf_allocator_);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::begin() const noexcept {
+    return const_iterator(leftmost_, 0);
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::end() const noexcept {
+    return const_iterator(rightmost_, rightmost_ == nullptr ? 0 : rightmost_->count_);
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::cbegin() const noexcept {
+    return begin();
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::cend() const noexcept {
+    return end();
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare, class Allocator>
+bool BTree<Key, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::size_type BTree<Key, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::size_type BTree<Key, Compare, Allocator>::max_size() const noexcept {
+    return std::numeric_limits<difference_type>::max();
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::size_type BTree<Key, Compare, Allocator>::height() const noexcept {
+    return height_;
+}
+
+
+// Implementation of modifiers
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::clear() noexcept {
+    if (root_ != nullptr) {
+        destroy(root_);
+    }
+    root_ = nullptr;
+    leftmost_ = nullptr;
+    rightmost_ = nullptr;
+    size_ = 0;
+    height_ = 0;
+}
+
+// Equal keys are inserted after the existing ones.
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::iterator BTree<Key, Compare, Allocator>::insert(const value_type& value) {
+    if (root_ == nullptr) {
+        leaf_type* leaf = make_leaf();
+        root_ = leaf;
+        leftmost_ = leaf;
+        rightmost_ = leaf;
+        height_ = 1;
+    }
+
+    node_type* node = root_;
+    while (!node->leaf_) {
+        inner_type* inner = static_cast<inner_type*>(node);
+        node = inner->children_[upper_index(inner->keys_, inner->count_, value)];
+    }
+    leaf_type* leaf = static_cast<leaf_type*>(node);
+    unsigned short position = upper_index(leaf->keys_, leaf->count_, value);
+
+    if (leaf->count_ == leaf_type::kCapacity) {
+        split_leaf(leaf);
+        if (position > leaf->count_) {
+            position -= leaf->count_;
+            leaf = leaf->next_;
+        }
+    }
+    std::move_backward(leaf->keys_ + position, leaf->keys_ + leaf->count_, leaf->keys_ + leaf->count_ + 1);
+    leaf->keys_[position] = value;
+    ++leaf->count_;
+    ++size_;
+    return const_iterator(leaf, position);
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+void BTree<Key, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+// A leaf that falls below half capacity borrows a key from a sibling or is merged with it. Keys only move
+// between the leaf and its siblings, so the returned position is tracked through both cases.
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::iterator BTree<Key, Compare, Allocator>::erase(const_iterator pos) {
+    leaf_type* leaf = const_cast<leaf_type*>(pos.get_leaf());
+    unsigned short position = pos.position();
+    std::move(leaf->keys_ + position + 1, leaf->keys_ + leaf->count_, leaf->keys_ + position);
+    --leaf->count_;
+    --size_;
+
+    if (leaf == root_) {
+        if (leaf->count_ == 0) {
+            clear();
+            return end();
+        }
+        return make_iterator(leaf, position);
+    }
+    if (leaf->count_ >= kMinLeafCount) {
+        return make_iterator(leaf, position);
+    }
+
+    inner_type* parent = leaf->parent_;
+    unsigned short index = child_index(parent, leaf);
+    leaf_type* left = index > 0 ? static_cast<leaf_type*>(parent->children_[index - 1]) : nullptr;
+    leaf_type* right = index < parent->count_ ? static_cast<leaf_type*>(parent->children_[index + 1]) : nullptr;
+
+    if (left != nullptr && left->count_ > kMinLeafCount) {
+        std::move_backward(leaf->keys_, leaf->keys_ + leaf->count_, leaf->keys_ + leaf->count_ + 1);
+        leaf->keys_[0] = std::move(left->keys_[left->count_ - 1]);
+        --left->count_;
+        ++leaf->count_;
+        parent->keys_[index - 1] = leaf->keys_[0];
+        return make_iterator(leaf, position + 1);
+    }
+    if (right != nullptr && right->count_ > kMinLeafCount) {
+        leaf->keys_[leaf->count_++] = std::move(right->keys_[0]);
+        std::move(right->keys_ + 1, right->keys_ + right->count_, right->keys_);
+        --right->count_;
+        parent->keys_[index] = right->keys_[0];
+        return make_iterator(leaf, position);
+    }
+    if (left != nullptr) {
+        unsigned short offset = left->count_;
+        merge_leaves(left, leaf, index - 1);
+        return make_iterator(left, offset + position);
+    }
+    merge_leaves(leaf, right, index);
+    return make_iterator(leaf, position);
+}
+
+// Rebalancing may move keys across leaves, so the range is erased by count rather than up to `last`.
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::iterator BTree<Key, Compare, Allocator>::erase(const_iterator first, const_iterator last) {
+    for (difference_type n = std::distance(first, last); n > 0; --n) {
+        first = erase(first);
+    }
+    return first;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::size_type BTree<Key, Compare, Allocator>::erase(const Key& key) {
+    size_type erased = 0;
+    for (const_iterator it = lower_bound(key); it != end() && !Compare()(key, *it); ++erased) {
+        it = erase(it);
+    }
+    return erased;
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::swap(BTree<Key, Compare, Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(leftmost_, other.leftmost_);
+    std::swap(rightmost_, other.rightmost_);
+    std::swap(size_, other.size_);
+    std::swap(height_, other.height_);
+    std::swap(leaf_allocator_, other.leaf_allocator_);
+    std::swap(inner_allocator_, other.inner_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::size_type BTree<Key, Compare, Allocator>::count(const Key& key) const {
+    size_type count = 0;
+    const_iterator last = end();
+    for (const_iterator it = lower_bound(key); it != last && !Compare()(key, *it); ++it) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::find(const Key& key) const {
+    const_iterator it = lower_bound(key);
+    if (it != end() && !Compare()(key, *it)) {
+        return it;
+    }
+    return end();
+}
+
+template<class Key, class Compare, class Allocator>
+bool BTree<Key, Compare, Allocator>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<class Key, class Compare, class Allocator>
+std::pair<typename BTree<Key, Compare, Allocator>::const_iterator, typename BTree<Key, Compare, Allocator>::const_iterator> BTree<Key, Compare, Allocator>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::lower_bound(const Key& key) const {
+    if (root_ == nullptr) {
+        return end();
+    }
+    const node_type* node = root_;
+    while (!node->leaf_) {
+        const inner_type* inner = static_cast<const inner_type*>(node);
+        node = inner->children_[lower_index(inner->keys_, inner->count_, key)];
+    }
+    const leaf_type* leaf = static_cast<const leaf_type*>(node);
+    return make_iterator(leaf, lower_index(leaf->keys_, leaf->count_, key));
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::upper_bound(const Key& key) const {
+    if (root_ == nullptr) {
+        return end();
+    }
+    const node_type* node = root_;
+    while (!node->leaf_) {
+        const inner_type* inner = static_cast<const inner_type*>(node);
+        node = inner->children_[upper_index(inner->keys_, inner->count_, key)];
+    }
+    const leaf_type* leaf = static_cast<const leaf_type*>(node);
+    return make_iterator(leaf, upper_index(leaf->keys_, leaf->count_, key));
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::key_compare BTree<Key, Compare, Allocator>::key_comp() const {
+    return Compare();
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::value_compare BTree<Key, Compare, Allocator>::value_comp() const {
+    return Compare();
+}
+
+template<class Key, class Compare, class Allocator>
+bool BTree<Key, Compare, Allocator>::operator==(const BTree<Key, Compare, Allocator>& rhs) const {
+    return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
+}
+
+template<class Key, class Compare, class Allocator>
+bool BTree<Key, Compare, Allocator>::operator!=(const BTree<Key, Compare, Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Compare, class Allocator>
+unsigned short BTree<Key, Compare, Allocator>::lower_index(const Key* keys, unsigned short count, const Key& key) {
+    return key_search<Key, Compare>::lower_index(keys, count, key);
+}
+
+template<class Key, class Compare, class Allocator>
+unsigned short BTree<Key, Compare, Allocator>::upper_index(const Key* keys, unsigned short count, const Key& key) {
+    return key_search<Key, Compare>::upper_index(keys, count, key);
+}
+
+template<class Key, class Compare, class Allocator>
+unsigned short BTree<Key, Compare, Allocator>::child_index(const inner_type* parent, const node_type* child) {
+    unsigned short index = 0;
+    while (parent->children_[index] != child) {
+        ++index;
+    }
+    return index;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::const_iterator BTree<Key, Compare, Allocator>::make_iterator(const leaf_type* leaf, unsigned short position) {
+    if (position == leaf->count_ && leaf->next_ != nullptr) {
+        return const_iterator(leaf->next_, 0);
+    }
+    return const_iterator(leaf, position);
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::leaf_type* BTree<Key, Compare, Allocator>::make_leaf() {
+    leaf_type* leaf = leaf_traits::allocate(leaf_allocator_, 1);
+    leaf_traits::construct(leaf_allocator_, leaf);
+    return leaf;
+}
+
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::inner_type* BTree<Key, Compare, Allocator>::make_inner() {
+    inner_type* inner = inner_traits::allocate(inner_allocator_, 1);
+    inner_traits::construct(inner_allocator_, inner);
+    return inner;
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::destroy(node_type* node) {
+    if (node->leaf_) {
+        leaf_type* leaf = static_cast<leaf_type*>(node);
+        leaf_traits::destroy(leaf_allocator_, leaf);
+        leaf_traits::deallocate(leaf_allocator_, leaf, 1);
+        return;
+    }
+    inner_type* inner = static_cast<inner_type*>(node);
+    for (unsigned short i = 0; i <= inner->count_; ++i) {
+        destroy(inner->children_[i]);
+    }
+    inner_traits::destroy(inner_allocator_, inner);
+    inner_traits::deallocate(inner_allocator_, inner, 1);
+}
+
+// Leaves are cloned left to right, so `previous` is the last leaf cloned so far and the copies are
+// linked as they are made.
+template<class Key, class Compare, class Allocator>
+BTree<Key, Compare, Allocator>::node_type* BTree<Key, Compare, Allocator>::clone(const node_type* node, inner_type* parent, leaf_type*& previous) {
+    if (node->leaf_) {
+        const leaf_type* leaf = static_cast<const leaf_type*>(node);
+        leaf_type* copy = make_leaf();
+        std::copy(leaf->keys_, leaf->keys_ + leaf->count_, copy->keys_);
+        copy->count_ = leaf->count_;
+        copy->parent_ = parent;
+        copy->prev_ = previous;
+        if (previous == nullptr) {
+            leftmost_ = copy;
+        } else {
+            previous->next_ = copy;
+        }
+        previous = copy;
+        return copy;
+    }
+    const inner_type* inner = static_cast<const inner_type*>(node);
+    inner_type* copy = make_inner();
+    std::copy(inner->keys_, inner->keys_ + inner->count_, copy->keys_);
+    copy->count_ = inner->count_;
+    copy->parent_ = parent;
+    for (unsigned short i = 0; i <= inner->count_; ++i) {
+        copy->children_[i] = clone(inner->children_[i], copy, previous);
+    }
+    return copy;
+}
+
+// Moves the upper half of a full leaf into a new right sibling and adds the sibling's first key to the parent.
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::split_leaf(leaf_type* leaf) {
+    leaf_type* right = make_leaf();
+    unsigned short middle = leaf->count_ / 2;
+    std::move(leaf->keys_ + middle, leaf->keys_ + leaf->count_, right->keys_);
+    right->count_ = leaf->count_ - middle;
+    leaf->count_ = middle;
+
+    right->next_ = leaf->next_;
+    if (right->next_ == nullptr) {
+        rightmost_ = right;
+    } else {
+        right->next_->prev_ = right;
+    }
+    right->prev_ = leaf;
+    leaf->next_ = right;
+    insert_into_parent(leaf, right->keys_[0], right);
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::insert_into_parent(node_type* left, const Key& separator, node_type* right) {
+    inner_type* parent = left->parent_;
+    if (parent == nullptr) {
+        parent = make_inner();
+        parent->children_[0] = left;
+        left->parent_ = parent;
+        root_ = parent;
+        ++height_;
+    }
+    unsigned short index = child_index(parent, left);
+    if (parent->count_ < inner_type::kCapacity) {
+        insert_into_inner(parent, index, separator, right);
+        return;
+    }
+
+    // The middle key moves up; the keys and children after it go to a new sibling.
+    inner_type* sibling = make_inner();
+    unsigned short middle = parent->count_ / 2;
+    Key promoted = std::move(parent->keys_[middle]);
+    std::move(parent->keys_ + middle + 1, parent->keys_ + parent->count_, sibling->keys_);
+    for (unsigned short i = middle + 1; i <= parent->count_; ++i) {
+        sibling->children_[i - middle - 1] = parent->children_[i];
+        parent->children_[i]->parent_ = sibling;
+    }
+    sibling->count_ = parent->count_ - middle - 1;
+    parent->count_ = middle;
+
+    if (index <= middle) {
+        insert_into_inner(parent, index, separator, right);
+    } else {
+        insert_into_inner(sibling, index - middle - 1, separator, right);
+    }
+    insert_into_parent(parent, promoted, sibling);
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::insert_into_inner(inner_type* inner, unsigned short index, const Key& separator, node_type* right) {
+    std::move_backward(inner->keys_ + index, inner->keys_ + inner->count_, inner->keys_ + inner->count_ + 1);
+    std::move_backward(inner->children_ + index + 1, inner->children_ + inner->count_ + 1, inner->children_ + inner->count_ + 2);
+    inner->keys_[index] = separator;
+    inner->children_[index + 1] = right;
+    right->parent_ = inner;
+    ++inner->count_;
+}
+
+// Appends `right` to `left` and removes `right` and the key separating them from the parent.
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::merge_leaves(leaf_type* left, leaf_type* right, unsigned short separator) {
+    std::move(right->keys_, right->keys_ + right->count_, left->keys_ + left->count_);
+    left->count_ += right->count_;
+    left->next_ = right->next_;
+    if (left->next_ == nullptr) {
+        rightmost_ = left;
+    } else {
+        left->next_->prev_ = left;
+    }
+    inner_type* parent = left->parent_;
+    leaf_traits::destroy(leaf_allocator_, right);
+    leaf_traits::deallocate(leaf_allocator_, right, 1);
+    erase_from_inner(parent, separator);
+}
+
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::merge_inners(inner_type* left, inner_type* right, unsigned short separator) {
+    inner_type* parent = left->parent_;
+    left->keys_[left->count_] = std::move(parent->keys_[separator]);
+    std::move(right->keys_, right->keys_ + right->count_, left->keys_ + left->count_ + 1);
+    for (unsigned short i = 0; i <= right->count_; ++i) {
+        left->children_[left->count_ + 1 + i] = right->children_[i];
+        right->children_[i]->parent_ = left;
+    }
+    left->count_ += right->count_ + 1;
+    inner_traits::destroy(inner_allocator_, right);
+    inner_traits::deallocate(inner_allocator_, right, 1);
+    erase_from_inner(parent, separator);
+}
+
+// Removes keys_[index] and children_[index + 1], then restores the minimum fill by rotating a key
+// through the parent from a sibling or by merging with it. A root left with one child is replaced by it.
+template<class Key, class Compare, class Allocator>
+void BTree<Key, Compare, Allocator>::erase_from_inner(inner_type* inner, unsigned short index) {
+    std::move(inner->keys_ + index + 1, inner->keys_ + inner->count_, inner->keys_ + index);
+    std::move(inner->children_ + index + 2, inner->children_ + inner->count_ + 1, inner->children_ + index + 1);
+    --inner->count_;
+
+    if (inner == root_) {
+        if (inner->count_ == 0) {
+            root_ = inner->children_[0];
+            root_->parent_ = nullptr;
+            inner_traits::destroy(inner_allocator_, inner);
+            inner_traits::deallocate(inner_allocator_, inner, 1);
+            --height_;
+        }
+        return;
+    }
+    if (inner->count_ >= kMinInnerCount) {
+        return;
+    }
+
+    inner_type* parent = inner->parent_;
+    unsigned short position = child_index(parent, inner);
+    inner_type* left = position > 0 ? static_cast<inner_type*>(parent->children_[position - 1]) : nullptr;
+    inner_type* right = position < parent->count_ ? static_cast<inner_type*>(parent->children_[position + 1]) : nullptr;
+
+    if (left != nullptr && left->count_ > kMinInnerCount) {
+        std::move_backward(inner->keys_, inner->keys_ + inner->count_, inner->keys_ + inner->count_ + 1);
+        std::move_backward(inner->children_, inner->children_ + inner->count_ + 1, inner->children_ + inner->count_ + 2);
+        inner->keys_[0] = std::move(parent->keys_[position - 1]);
+        inner->children_[0] = left->children_[left->count_];
+        inner->children_[0]->parent_ = inner;
+        parent->keys_[position - 1] = std::move(left->keys_[left->count_ - 1]);
+        --left->count_;
+        ++inner->count_;
+        return;
+    }
+    if (right != nullptr && right->count_ > kMinInnerCount) {
+        inner->keys_[inner->count_] = std::move(parent->keys_[position]);
+        inner->children_[inner->count_ + 1] = right->children_[0];
+        inner->children_[inner->count_ + 1]->parent_ = inner;
+        ++inner->count_;
+        parent->keys_[position] = std::move(right->keys_[0]);
+        std::move(right->keys_ + 1, right->keys_ + right->count_, right->keys_);
+        std::move(right->children_ + 1, right->children_ + right->count_ + 1, right->children_);
+        --right->count_;
+        return;
+    }
+    if (left != nullptr) {
+        merge_inners(left, inner, position - 1);
+    } else {
+        merge_inners(inner, right, position);
+    }
+}
@@ -1,11 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <thread>
 
 #include "Node.h"
+#include "MemoryUsage.h"
+#include "NodePool.h"
+#include "FrozenBinarySearchTree.h"
+#include "Instrumentation.h"
 #include "Iterator.h"
-
-template<class Key, class Traversal = InOrder, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+#include "MappedBinarySearchTree.h"
+#include "Serialization.h"
+#include "TreeShape.h"
+#include "VebBinarySearchTree.h"
+
+// Concurrent const lookups are safe for the Unbalanced and Scapegoat policies. A Splay tree restructures
+// itself inside find(), contains() and lower_bound(), so even its const readers need exclusive access.
+template<class Key, class Traversal = InOrder, class Compare = std::less<Key>, class Allocator = std::allocator<Key>, class Instrumentation = NoInstrumentation, class Balance = Unbalanced>
 class BinarySearchTree {
 public:
     typedef Key key_type;
@@ -21,10 +39,13 @@ public:
     typedef std::allocator_traits<Allocator>::const_pointer const_pointer;
     typedef Node<Key, Compare, Allocator> node_type;
     
-    typedef const_iterator_<Key, Traversal> iterator;
-    typedef const_iterator_<Key, Traversal> const_iterator;
-    typedef const_reverse_iterator_<Key, Traversal> reverse_iterator;
-    typedef const_reverse_iterator_<Key, Traversal> const_reverse_iterator;
+    typedef Instrumentation instrumentation_type;
+    typedef Balance balance_type;
+    
+    typedef const_iterator_<Key, Traversal, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&, Instrumentation> iterator;
+    typedef const_iterator_<Key, Traversal, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&, Instrumentation> const_iterator;
+    typedef const_reverse_iterator_<Key, Traversal, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&, Instrumentation> reverse_iterator;
+    typedef const_reverse_iterator_<Key, Traversal, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&, Instrumentation> const_reverse_iterator;
 
     // member functions
 
@@ -35,15 +56,15 @@ public:
     BinarySearchTree(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
     template<class InputIt>
     BinarySearchTree(InputIt first, InputIt last, const Allocator& alloc);
-    BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other);
-    BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other, const Allocator& alloc);
+    BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other);
+    BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other, const Allocator& alloc);
     BinarySearchTree(std::initializer_list<value_type> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator());
     BinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc);
 
     ~BinarySearchTree();
 
-    BinarySearchTree<Key, Traversal, Compare, Allocator>& operator=(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other);
-    BinarySearchTree<Key, Traversal, Compare, Allocator>& operator=( std::initializer_list<value_type> ilist);
+    BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& operator=(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other);
+    BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& operator=( std::initializer_list<value_type> ilist);
 
     allocator_type get_allocator() const noexcept;
 
@@ -99,6 +120,13 @@ public:
     [[nodiscard]] bool empty() const noexcept;
     [[nodiscard]] size_type size() const noexcept;
     [[nodiscard]] size_type max_size() const noexcept;
+    // Nodes the tree can hold before inserts go back to the allocator. Spare capacity survives
+    // clear() and is released by shrink_to_fit() and compact().
+    void reserve(size_type count);
+    [[nodiscard]] size_type capacity() const noexcept;
+    void shrink_to_fit();
+    // O(1): the modifiers keep every total up to date.
+    [[nodiscard]] MemoryUsage memory_usage() const noexcept;
 
 
     // Modifiers
@@ -110,12 +138,13 @@ public:
     template<class InputIt>
     void insert(InputIt first, InputIt last);
     void insert(std::initializer_list<value_type> ilist);
+    void insert_batch(std::span<const value_type> batch, unsigned threads = 0);
 
     iterator erase(const_iterator pos);
     iterator erase(const_iterator first, const_iterator last);
     size_type erase(const Key& key);
 
-    void swap(BinarySearchTree<Key, Traversal, Compare, Allocator>& other) noexcept;
+    void swap(BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other) noexcept;
 
     node_type extract(const_iterator position);
     node_type extract(const Key& k);
@@ -134,25 +163,84 @@ public:
     std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
 
     const_iterator lower_bound(const Key& key) const;
+    // The node lower_bound() points to, or nullptr instead of an end sentinel.
+    node_type* lower_bound_node(const Key& key) const;
 
     const_iterator upper_bound(const Key& key) const;
 
 
+    // Serialization
+
+    void save(std::ostream& os) const;
+    size_type save(std::span<std::byte> buffer) const;
+    bool load(std::istream& is);
+    bool load(std::span<const std::byte> buffer);
+    size_type serialized_size() const;
+    void save_mapped(std::ostream& os) const;
+
     // Observers
     key_compare key_comp() const;
     value_compare value_comp() const;
 
+    // Instrumentation
+    InstrumentationStats stats() const noexcept;
+    void reset_stats() noexcept;
+
+    // Shape diagnostics
+    size_type height() const;
+    size_type height_estimate() const noexcept;
+    TreeShape shape() const;
+
+    // Balancing
+    void rebalance();
+    void set_rebalance_factor(double factor) noexcept;
+    double rebalance_factor() const noexcept;
+
+    // Snapshots
+    FrozenBinarySearchTree<Key, Compare> freeze() const;
+    VebBinarySearchTree<Key, Compare> freeze(tag<VanEmdeBoas>) const;
+
+    // Memory layout
+    // Moves every node into one new contiguous block in key order, so scans and the upper levels of
+    // descents read sequential memory. Invalidates all iterators and releases spare capacity.
+    void compact();
+    // Maps node blocks allocated from now on with 2 MiB pages, and makes single inserts take slots
+    // from such blocks instead of the allocator, so that a descent over a large tree touches fewer
+    // pages. Existing nodes stay where they are until compact().
+    void set_huge_pages(bool enable = true) noexcept;
+    [[nodiscard]] bool huge_pages() const noexcept;
+    // Node storage mapped with the given backing, see PageBacking.
+    [[nodiscard]] size_type mapped_bytes(PageBacking backing) const noexcept;
+
     // Non-member functions
     template<class K, class C, class A>
-    friend bool operator==(const BinarySearchTree<K, C, A>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs);
+    friend bool operator==(const BinarySearchTree<K, C, A>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs);
     template<class K, class C, class A>
-    friend bool operator!=(const BinarySearchTree<K, C, A>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs);
+    friend bool operator!=(const BinarySearchTree<K, C, A>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs);
 
-    bool operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs);
-    bool operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs);
+    bool operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs);
+    bool operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs);
 private:
-    node_type* root_ = nullptr;
+    // Mutable because Splay trees restructure themselves on lookups, which therefore must not run concurrently.
+    mutable node_type* root_ = nullptr;
     unsigned long long size_ = 0;
+    // Upper bound on height(): raised by inserts, left unchanged by erase and reset when rebuilt.
+    // Splay lookups may deepen the tree without raising it.
+    unsigned long long height_estimate_ = 0;
+    // Largest size since the last full rebuild; read by the Scapegoat policy only.
+    unsigned long long max_size_ = 0;
+    // 0 disables automatic rebalancing.
+    double rebalance_factor_ = 0;
+    [[no_unique_address]] Instrumentation instrumentation_;
+    // Blocks made by reserve(), compact() and parallel insert_batch(); other nodes are allocated one by one.
+    NodePool<node_type> pool_;
+    // Heap payload of the keys and its allocator overhead, per key_heap_usage.
+    size_type key_heap_bytes_ = 0;
+    size_type key_heap_overhead_ = 0;
+    // Pool slots still held by nodes extract() unlinked; they are neither free nor in the tree.
+    size_type extracted_slots_ = 0;
+
+    bool less(const Key& lhs, const Key& rhs) const;
 
     node_type* find_node(const Key& key) const;
 
@@ -161,12 +249,55 @@ private:
     void swap(node_type* node_1, node_type* node_2);
 
     void delete_children(node_type* node);
+    void destroy_node(node_type* node);
+    void track_key(const Key& key, bool added);
+    // Recomputes the key heap totals after nodes were built without insert_node().
+    void recount_key_heap();
+    // load() body; `available` bounds the bytes that can follow the header, -1 when unknown.
+    bool load(std::istream& is, std::uint64_t available);
+
+    void replace_child(node_type* parent, node_type* old_child, node_type* new_child) const;
+    void rotate_left(node_type* node) const;
+    void rotate_right(node_type* node) const;
+    node_type* compress(node_type* top, size_type count);
+    size_type rebuild(node_type* top);
+    void rebalance_if_degraded();
+    static size_type subtree_size(node_type* top);
+
+    void after_insert(node_type* node, size_type depth, tag<Unbalanced>);
+    void after_insert(node_type* node, size_type depth, tag<Scapegoat>);
+    void after_erase(tag<Unbalanced>);
+    void after_erase(tag<Scapegoat>);
+    void after_insert(node_type* node, size_type depth, tag<Splay>);
+    void after_erase(tag<Splay>);
+    void after_access(node_type* node, tag<Unbalanced>) const;
+    void after_access(node_type* node, tag<Scapegoat>) const;
+    void after_access(node_type* node, tag<Splay>) const;
+    void splay(node_type* node) const;
 
     iterator insert(const value_type &value, const Compare &comp, const Allocator &allocator);
+
+    // The new node goes into `storage` when given, otherwise into a free pool slot or a fresh allocation.
+    node_type* insert_node(node_type*& subtree_root, node_type* parent, const value_type& value, size_type& depth, node_type* storage = nullptr);
+
+    struct batch_task {
+        node_type** slot;
+        node_type* parent;
+        const Key* first;
+        const Key* last;
+        size_type height;
+    };
+
+    static void sort_batch(Key* keys, size_type n, unsigned threads);
+    static void split_batch(node_type** slot, node_type* parent, const Key* first, const Key* last, unsigned depth, batch_task* tasks, size_type& task_count);
+    void insert_sorted(node_type*& subtree_root, node_type* parent, const Key* first, const Key* last, size_type depth, size_type& height, node_type* storage);
+
+    static node_type* build_balanced(Key* keys, size_type first, size_type last, node_type* parent);
+    static size_type link_mapped(MappedNode<Key>* nodes, size_type first, size_type last);
 };
 
-template<class Key, class Traversal, class Compare, class Allocator>
-std::pair<typename BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator, typename BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator> BinarySearchTree<Key, Traversal, Compare, Allocator>::equal_range(const Key &key) const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+std::pair<typename BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator, typename BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator> BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::equal_range(const Key &key) const {
     return std::make_pair(this->lower_bound(key), this->upper_bound(key));
 }
 
@@ -179,16 +310,16 @@ BinarySearchTree<Key>::node_type* next_node(typename BinarySearchTree<Key>::node
 template<class Key>
 BinarySearchTree<Key>::node_type* prev_node(typename BinarySearchTree<Key>::node_type* node);
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool BinarySearchTree<Key, Traversal, Compare, Allocator>::operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs) {
     if (this->size_ != rhs.size_ || (this->root_ == nullptr ^ rhs.root_ == nullptr)) {
         return false;
     }
     return (*this->root_ == *rhs.root_);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool BinarySearchTree<Key, Traversal, Compare, Allocator>::operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs) {
     if (this->size_ != rhs.size_ || (this->root_ == nullptr ^ rhs.root_ == nullptr)) {
         return true;
     }
@@ -197,29 +328,29 @@ bool BinarySearchTree<Key, Traversal, Compare, Allocator>::operator!=(const Bina
 
 // Non-member functions
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void swap(BinarySearchTree<Key, Traversal, Compare, Allocator>& lhs, BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void swap(BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& lhs, BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool operator==(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs) {
     if (lhs.size_ != rhs.size_ || (lhs.root_ == nullptr ^ rhs.root_ == nullptr)) {
         return false;
     }
     return (*lhs.root_ == *rhs.root_);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool operator!=(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& lhs, const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& rhs) {
     if (lhs.size_ != rhs.size_ || (lhs.root_ == nullptr ^ rhs.root_ == nullptr)) {
         return true;
     }
     return (*lhs.root_ != *rhs.root_);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator, class Predicate>
-typename BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type erase_if(BinarySearchTree<Key, Traversal, Compare, Allocator>& c, Predicate predicate) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance, class Predicate>
+typename BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type erase_if(BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& c, Predicate predicate) {
     auto old_size = c.size();
     for (auto first = c.begin(), last = c.end(); first != last;) {
         if (predicate(*first)) {
@@ -234,71 +365,73 @@ typename BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type erase_i
 
 // Implementation of member functions
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree() : BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(Compare()) {}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree() : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(Compare()) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(const Compare& comp, const Allocator& alloc) {
-    this->~BinarySearchTree<Key, Traversal, Compare, Allocator>();
-    root_ = nullptr;
-    size_ = 0;
-}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(const Compare& comp, const Allocator& alloc) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator>(Compare(), alloc) {}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>(Compare(), alloc) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class InputIt>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc) {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(InputIt first, InputIt last, const Compare& comp, const Allocator& alloc) {
     for (InputIt it = first; it != last; ++it) {
         insert(*it, comp, alloc);
     }
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class InputIt>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator>(first, last, Compare(), alloc) {}
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>(first, last, Compare(), alloc) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other) : BinarySearchTree<Key, Traversal, Compare, Allocator>(other, std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.get_allocator())) {}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other) : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>(other, std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.get_allocator())) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other, const Allocator& alloc) {
-    this->~BinarySearchTree<Key, Traversal, Compare, Allocator>();
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other, const Allocator& alloc) {
     root_ = new Node<Key, Compare, Allocator>(*other.root_, alloc);
     size_ = other.size_;
+    height_estimate_ = other.height_estimate_;
+    rebalance_factor_ = other.rebalance_factor_;
+    max_size_ = other.max_size_;
+    pool_.set_huge_pages(other.pool_.huge_pages());
+    recount_key_heap();
+    instrumentation_.on_allocate(size_);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(std::initializer_list<value_type> init, const Compare& comp, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator>(init.begin(), init.end(), comp, alloc) {}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(std::initializer_list<value_type> init, const Compare& comp, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>(init.begin(), init.end(), comp, alloc) {}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::BinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator>(init, Compare(), alloc) {}
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::BinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>(init, Compare(), alloc) {}
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::~BinarySearchTree() {
-    if (this->empty()) {
-        return;
-    }
-    delete_children(root_);
-    root_ = nullptr;
-    size_ = 0;
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::~BinarySearchTree() {
+    clear();
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>& BinarySearchTree<Key, Traversal, Compare, Allocator>::operator=(const BinarySearchTree<Key, Traversal, Compare, Allocator>& other) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::operator=(const BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other) {
     if (this !=& other) {
-        this->~BinarySearchTree<Key, Traversal, Compare, Allocator>();
+        clear();
         root_ = new Node<Key, Compare, Allocator>(*other.root_);
         size_ = other.size_;
+        height_estimate_ = other.height_estimate_;
+        rebalance_factor_ = other.rebalance_factor_;
+        max_size_ = other.max_size_;
+        pool_.set_huge_pages(other.pool_.huge_pages());
+        recount_key_heap();
+        instrumentation_.on_allocate(size_);
     }
     return *this;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>& BinarySearchTree<Key, Traversal, Compare, Allocator>::operator=(std::initializer_list<value_type> ilist) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::operator=(std::initializer_list<value_type> ilist) {
     for (auto it = ilist.begin(); it != ilist.end(); ++it) {
         insert(*it);
     }
@@ -306,445 +439,911 @@ BinarySearchTree<Key, Traversal, Compare, Allocator>& BinarySearchTree<Key, Trav
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::allocator_type BinarySearchTree<Key, Traversal, Compare, Allocator>::get_allocator() const noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::allocator_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::get_allocator() const noexcept {
     return Allocator();
 }
 
 
 // Iterator
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::begin() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::begin() const noexcept {
     if (root_ == nullptr) {
         return end();
     }
     return begin(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::begin(tag<InOrder>) const noexcept {
-    return iterator(minimum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::begin(tag<InOrder>) const noexcept {
+    return iterator(minimum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::begin(tag<PreOrder>) const noexcept {
-    return iterator(root_);
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::begin(tag<PreOrder>) const noexcept {
+    return iterator(root_, instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::begin(tag<PostOrder>) const noexcept {
-    return iterator(minimum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::begin(tag<PostOrder>) const noexcept {
+    return iterator(minimum<Key>(root_), instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cbegin() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cbegin() const noexcept {
     if (root_ == nullptr) {
         return cend();
     }
     return cbegin(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cbegin(tag<InOrder>) const noexcept {
-    return const_iterator(minimum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cbegin(tag<InOrder>) const noexcept {
+    return const_iterator(minimum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cbegin(tag<PreOrder>) const noexcept {
-    return const_iterator(root_);
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cbegin(tag<PreOrder>) const noexcept {
+    return const_iterator(root_, instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cbegin(tag<PostOrder>) const noexcept {
-    return const_iterator(minimum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cbegin(tag<PostOrder>) const noexcept {
+    return const_iterator(minimum<Key>(root_), instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::end() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::end() const noexcept {
     if (root_ == nullptr) {
-        return iterator(new Node<Key, Compare, Allocator>(nullptr));
+        return iterator(new Node<Key, Compare, Allocator>(nullptr), instrumentation_.handle());
     }
     return end(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::end(tag<InOrder>) const noexcept {
-    return iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::end(tag<InOrder>) const noexcept {
+    return iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::end(tag<PreOrder>) const noexcept {
-    return iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::end(tag<PreOrder>) const noexcept {
+    return iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::end(tag<PostOrder>) const noexcept {
-    return iterator(new Node<Key, Compare, Allocator>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::end(tag<PostOrder>) const noexcept {
+    return iterator(new Node<Key, Compare, Allocator>(root_), instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cend() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cend() const noexcept {
     if (root_ == nullptr) {
-        return const_iterator(new Node<Key, Compare, Allocator>(nullptr));
+        return const_iterator(new Node<Key, Compare, Allocator>(nullptr), instrumentation_.handle());
     }
     return cend(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cend(tag<InOrder>) const noexcept {
-    return const_iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cend(tag<InOrder>) const noexcept {
+    return const_iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cend(tag<PreOrder>) const noexcept {
-    return const_iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cend(tag<PreOrder>) const noexcept {
+    return const_iterator(new Node<Key, Compare, Allocator>(maximum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::cend(tag<PostOrder>) const noexcept {
-    return const_iterator(new Node<Key, Compare, Allocator>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::cend(tag<PostOrder>) const noexcept {
+    return const_iterator(new Node<Key, Compare, Allocator>(root_), instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rbegin() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rbegin() const noexcept {
     if (root_ == nullptr) {
         return rend();
     }
     return rbegin(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rbegin(tag<InOrder>) const noexcept {
-    return reverse_iterator(maximum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rbegin(tag<InOrder>) const noexcept {
+    return reverse_iterator(maximum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rbegin(tag<PreOrder>) const noexcept {
-    return reverse_iterator(maximum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rbegin(tag<PreOrder>) const noexcept {
+    return reverse_iterator(maximum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rbegin(tag<PostOrder>) const noexcept {
-    return reverse_iterator(root_);
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rbegin(tag<PostOrder>) const noexcept {
+    return reverse_iterator(root_, instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crbegin() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crbegin() const noexcept {
     if (root_ == nullptr) {
         return crend();
     }
     return crbegin(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crbegin(tag<InOrder>) const noexcept {
-    return const_reverse_iterator(maximum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crbegin(tag<InOrder>) const noexcept {
+    return const_reverse_iterator(maximum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crbegin(tag<PreOrder>) const noexcept {
-    return const_reverse_iterator(maximum<Key>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crbegin(tag<PreOrder>) const noexcept {
+    return const_reverse_iterator(maximum<Key>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crbegin(tag<PostOrder>) const noexcept {
-    return const_reverse_iterator(root_);
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crbegin(tag<PostOrder>) const noexcept {
+    return const_reverse_iterator(root_, instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rend() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rend() const noexcept {
     if (root_ == nullptr) {
-        return reverse_iterator(new Node<Key, Compare, Allocator>(nullptr));
+        return reverse_iterator(new Node<Key, Compare, Allocator>(nullptr), instrumentation_.handle());
     }
     return rend(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rend(tag<InOrder>) const noexcept {
-    return reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rend(tag<InOrder>) const noexcept {
+    return reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rend(tag<PreOrder>) const noexcept {
-    return reverse_iterator(new Node<Key, Compare, Allocator>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rend(tag<PreOrder>) const noexcept {
+    return reverse_iterator(new Node<Key, Compare, Allocator>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::rend(tag<PostOrder>) const noexcept {
-    return reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rend(tag<PostOrder>) const noexcept {
+    return reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)), instrumentation_.handle());
 }
 
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class Traversal2>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crend() const noexcept {
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crend() const noexcept {
     if (root_ == nullptr) {
-        return const_reverse_iterator(new Node<Key, Compare, Allocator>(nullptr));
+        return const_reverse_iterator(new Node<Key, Compare, Allocator>(nullptr), instrumentation_.handle());
     }
     return crend(tag<Traversal2>{});
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crend(tag<InOrder>) const noexcept {
-    return const_reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crend(tag<InOrder>) const noexcept {
+    return const_reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crend(tag<PreOrder>) const noexcept {
-    return const_reverse_iterator(new Node<Key, Compare, Allocator>(root_));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crend(tag<PreOrder>) const noexcept {
+    return const_reverse_iterator(new Node<Key, Compare, Allocator>(root_), instrumentation_.handle());
 }
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::crend(tag<PostOrder>) const noexcept {
-    return const_reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_reverse_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::crend(tag<PostOrder>) const noexcept {
+    return const_reverse_iterator(new Node<Key, Compare, Allocator>(minimum<Key>(root_)), instrumentation_.handle());
 }
 
 
 // Implementation of capacity
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool BinarySearchTree<Key, Traversal, Compare, Allocator>::empty() const noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::empty() const noexcept {
     return size_ == 0;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator>::size() const noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size() const noexcept {
     return size_;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator>::max_size() const noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::max_size() const noexcept {
     return static_cast<size_type>(-1);
 }
 
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reserve(size_type count) {
+    if (count > size_) {
+        pool_.reserve(count - size_);
+    }
+}
 
-// Implementation of modifiers
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::capacity() const noexcept {
+    return size_ + pool_.free_count();
+}
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::clear() noexcept {
-    this->~BinarySearchTree<Key, Traversal, Compare, Allocator>();
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::shrink_to_fit() {
+    pool_.shrink_to_fit();
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::insert(const value_type& value) {
-    ++size_;
-    if (root_ == nullptr) {
-        root_ = new node_type(value, nullptr);
-        return iterator(root_);
-    }
-    node_type* current_node = root_;
-    while (current_node != nullptr) {
-        if (Compare()(current_node->data_, value)) {
-            if (current_node->right_ != nullptr) {
-                current_node = current_node->right_;
-            } else {
-                current_node->right_ = new node_type(value, current_node);
-                return iterator(current_node->right_);
-            }
-        } else {
-            if (current_node->left_ != nullptr) {
-                current_node = current_node->left_;
-            } else {
-                current_node->left_ = new node_type(value, current_node);
-                return iterator(current_node->left_);
-            }
-        }
+// Nodes not in a pool slot were allocated one by one and pay the allocator's overhead each.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+MemoryUsage BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::memory_usage() const noexcept {
+    size_type single_nodes = size_ - (pool_.slot_count() - pool_.free_count() - extracted_slots_);
+    MemoryUsage usage;
+    usage.nodes = size_;
+    usage.node_bytes = size_ * sizeof(node_type);
+    usage.key_heap_bytes = key_heap_bytes_;
+    usage.reserved_bytes = pool_.free_count() * sizeof(node_type);
+    usage.overhead_bytes = single_nodes * heap_overhead(sizeof(node_type)) + pool_.overhead_bytes() + key_heap_overhead_;
+    return usage;
+}
+
+
+// Implementation of modifiers
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::clear() noexcept {
+    if (this->empty()) {
+        return;
     }
-    return end();
+    delete_children(root_);
+    root_ = nullptr;
+    size_ = 0;
+    height_estimate_ = 0;
+    max_size_ = 0;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::insert(const value_type& value, const Compare& comp, const Allocator& allocator) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert(const value_type& value) {
     ++size_;
-    if (root_ == nullptr) {
-        root_ = new node_type(value, nullptr);
-        return iterator(root_);
-    }
-    node_type* current_node = root_;
-    while (current_node != nullptr) {
-        if (comp(current_node->data_, value)) {
-            if (current_node->right_ != nullptr) {
-                current_node = current_node->right_;
-            } else {
-                current_node->right_ = new node_type(value, current_node);
-                return iterator(current_node->right_);
-            }
-        } else {
-            if (current_node->left_ != nullptr) {
-                current_node = current_node->left_;
-            } else {
-                current_node->left_ = new node_type(value, current_node);
-                return iterator(current_node->left_);
-            }
-        }
-    }
-    return end();
+    size_type depth = 0;
+    node_type* node = insert_node(root_, nullptr, value, depth);
+    height_estimate_ = std::max(height_estimate_, depth + 1);
+    after_insert(node, depth, tag<Balance>{});
+    rebalance_if_degraded();
+    return iterator(node, instrumentation_.handle());
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::insert(BinarySearchTree::const_iterator pos, const value_type& value) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert(const value_type& value, const Compare& comp, const Allocator& allocator) {
     return insert(value);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert(BinarySearchTree::const_iterator pos, const value_type& value) {
+    return insert(value);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class InputIt>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::insert(InputIt first, InputIt last) {
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert(InputIt first, InputIt last) {
     for (; first != last; ++first) {
         insert(*first);
     }
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert(std::initializer_list<value_type> ilist) {
     insert(ilist.begin(), ilist.end());
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::erase(BinarySearchTree::const_iterator pos) {
+// The sorted batch is partitioned down the top levels of the tree, so every piece belongs to a distinct
+// child slot and the pieces are inserted concurrently without touching each other's nodes.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert_batch(std::span<const value_type> batch, unsigned threads) {
+    size_type n = batch.size();
+    if (n == 0) {
+        return;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (n < (1 << 14)) {
+        threads = 1;
+    }
+
+    std::unique_ptr<Key[]> keys(new Key[n]);
+    std::copy(batch.begin(), batch.end(), keys.get());
+    sort_batch(keys.get(), n, threads);
+
+    unsigned depth = 0;
+    while (threads > 1 && (1u << depth) < 4 * threads && depth < 8) {
+        ++depth;
+    }
+    std::unique_ptr<batch_task[]> tasks(new batch_task[1u << depth]);
+    size_type task_count = 0;
+    split_batch(&root_, nullptr, keys.get(), keys.get() + n, depth, tasks.get(), task_count);
+
+    // Workers cannot share the pool's free list, so a parallel batch gets a block of its own with one
+    // slot per key in sorted order.
+    node_type* storage = task_count > 1 ? pool_.allocate_block(n) : nullptr;
+    std::atomic<size_type> next_task = 0;
+    auto worker = [this, &tasks, &next_task, task_count, storage, &keys]() {
+        for (size_type i = next_task++; i < task_count; i = next_task++) {
+            size_type depth = 0;
+            for (node_type* node = tasks[i].parent; node != nullptr; node = node->parent_) {
+                ++depth;
+            }
+            node_type* task_storage = storage == nullptr ? nullptr : storage + (tasks[i].first - keys.get());
+            insert_sorted(*tasks[i].slot, tasks[i].parent, tasks[i].first, tasks[i].last, depth, tasks[i].height, task_storage);
+        }
+    };
+    unsigned workers = static_cast<unsigned>(std::min<size_type>(threads, task_count));
+    std::unique_ptr<std::thread[]> pool(new std::thread[workers]);
+    for (unsigned i = 1; i < workers; ++i) {
+        pool[i] = std::thread(worker);
+    }
+    worker();
+    for (unsigned i = 1; i < workers; ++i) {
+        pool[i].join();
+    }
+    for (size_type i = 0; storage != nullptr && i < n; ++i) {
+        track_key(storage[i].data_, true);
+    }
+    for (size_type i = 0; i < task_count; ++i) {
+        height_estimate_ = std::max(height_estimate_, tasks[i].height);
+    }
+    size_ += n;
+    after_insert(nullptr, height_estimate_ - 1, tag<Balance>{});
+    rebalance_if_degraded();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::erase(BinarySearchTree::const_iterator pos) {
     const_iterator tmp(pos);
     tmp++;
     node_type* erased_node = pos.get_node();
     erase(root_, erased_node);
+    destroy_node(erased_node);
+    after_erase(tag<Balance>{});
     return tmp;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::erase(BinarySearchTree::const_iterator first, BinarySearchTree::const_iterator last) {
-    node_type* erased_node;
-    for (; first != last; ++first) {
-        erased_node = first.get_node();
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::erase(BinarySearchTree::const_iterator first, BinarySearchTree::const_iterator last) {
+    // Steps past each node before it is unlinked and freed.
+    while (first != last) {
+        node_type* erased_node = first.get_node();
+        ++first;
         erase(root_, erased_node);
+        destroy_node(erased_node);
     }
+    after_erase(tag<Balance>{});
     return last;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator>::erase(const Key& key) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::erase(const Key& key) {
     node_type* erased_node = find_node(key);
     size_type counter = 0;
     while (erased_node != nullptr) {
         erase(root_, erased_node);
+        destroy_node(erased_node);
         ++counter;
         erased_node = find_node(key);
     }
+    after_erase(tag<Balance>{});
     return counter;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::swap(BinarySearchTree<Key, Traversal, Compare, Allocator>& other) noexcept {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::swap(BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>& other) noexcept {
     node_type* temp_root = this->root_;
     this->root_ = other.root_;
     other.root_ = temp_root;
     size_type temp_size = this->size_;
     this->size_ = other.size_;
     other.size_ = temp_size;
+    std::swap(height_estimate_, other.height_estimate_);
+    std::swap(rebalance_factor_, other.rebalance_factor_);
+    std::swap(max_size_, other.max_size_);
+    pool_.swap(other.pool_);
+    std::swap(key_heap_bytes_, other.key_heap_bytes_);
+    std::swap(key_heap_overhead_, other.key_heap_overhead_);
+    std::swap(extracted_slots_, other.extracted_slots_);
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::node_type BinarySearchTree<Key, Traversal, Compare, Allocator>::extract(BinarySearchTree::const_iterator position) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::extract(BinarySearchTree::const_iterator position) {
     node_type* erased_node = position.get_node();
     erase(root_, erased_node);
+    extracted_slots_ += pool_.owns(erased_node);
+    after_erase(tag<Balance>{});
     return *erased_node;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::node_type BinarySearchTree<Key, Traversal, Compare, Allocator>::extract(const Key& k) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::extract(const Key& k) {
     node_type* erased_node = find_node(k);
     erase(root_, erased_node);
+    extracted_slots_ += pool_.owns(erased_node);
+    after_erase(tag<Balance>{});
     return *erased_node;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
 template<class C2>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::merge(BinarySearchTree<Key, C2, Allocator>& source) {
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::merge(BinarySearchTree<Key, C2, Allocator>& source) {
     insert(source.begin(), source.end());
 }
 
 
 // Implementation of lookup
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator>::count(const Key& key) const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::count(const Key& key) const {
     if (root_ == nullptr) {
         return 0;
     }
 
-    size_type count = 0;
+    // Rotations may leave keys equal to a node in its right subtree, so the count starts from the first
+    // equal key in order rather than from the equal nodes on one search path.
+    node_type* first_equal = nullptr;
     node_type* current_node = root_;
+    instrumentation_.on_descent();
     while (current_node != nullptr) {
-        if (!Compare()(current_node->data_, key) && !Compare()(key, current_node->data_)) {
-            ++count;
-        }
-        if (Compare(current_node->data_, key)) {
+        instrumentation_.on_visit();
+        if (less(current_node->data_, key)) {
             current_node = current_node->right_;
         } else {
+            if (!less(key, current_node->data_)) {
+                first_equal = current_node;
+            }
             current_node = current_node->left_;
         }
     }
 
+    size_type count = 0;
+    for (; first_equal != nullptr && !less(key, first_equal->data_); first_equal = next_node<Key>(first_equal)) {
+        ++count;
+    }
     return count;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::find(const Key& key) const {
-    return const_iterator(find_node(key));
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::find(const Key& key) const {
+    node_type* node = find_node(key);
+    after_access(node, tag<Balance>{});
+    return const_iterator(node, instrumentation_.handle());
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-bool BinarySearchTree<Key, Traversal, Compare, Allocator>::contains(const Key& key) const {
-    return find_node(key) != nullptr;
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::contains(const Key& key) const {
+    node_type* node = find_node(key);
+    after_access(node, tag<Balance>{});
+    return node != nullptr;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::lower_bound(const Key& key) const {
-    if (root_ == nullptr) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::lower_bound(const Key& key) const {
+    node_type* node = lower_bound_node(key);
+    if (node == nullptr) {
         return this->cend();
     }
+    return const_iterator(node, instrumentation_.handle());
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::lower_bound_node(const Key& key) const {
+    if (root_ == nullptr) {
+        return nullptr;
+    }
     node_type* current_node = root_;
-    while (current_node->left_ != nullptr && !Compare()(current_node->data_, key)) {
+    instrumentation_.on_descent();
+    instrumentation_.on_visit();
+    while (current_node->left_ != nullptr && !less(current_node->data_, key)) {
         current_node = current_node->left_;
+        instrumentation_.on_visit();
     }
-    while (next_node<Key>(current_node) != nullptr && Compare()(current_node->data_, key)) {
+    while (next_node<Key>(current_node) != nullptr && less(current_node->data_, key)) {
         current_node = next_node<Key>(current_node);
+        instrumentation_.on_visit();
     }
-    if (next_node<Key>(current_node) == nullptr && Compare()(current_node->data_, key)) {
-        return this->cend();
+    if (next_node<Key>(current_node) == nullptr && less(current_node->data_, key)) {
+        return nullptr;
     }
-    return const_iterator(current_node);
+    after_access(current_node, tag<Balance>{});
+    return current_node;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator>::upper_bound(const Key& key) const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::const_iterator BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::upper_bound(const Key& key) const {
     if (root_ == nullptr) {
         return this->cend();
     }
     node_type* current_node = root_;
-    while (current_node->left_ != nullptr && Compare()(key, current_node->data_)) {
+    instrumentation_.on_descent();
+    instrumentation_.on_visit();
+    while (current_node->left_ != nullptr && less(key, current_node->data_)) {
         current_node = current_node->left_;
+        instrumentation_.on_visit();
     }
-    while (next_node<Key>(current_node) != nullptr && !Compare()(key, current_node->data_)) {
+    while (next_node<Key>(current_node) != nullptr && !less(key, current_node->data_)) {
         current_node = next_node<Key>(current_node);
+        instrumentation_.on_visit();
     }
-    if (next_node<Key>(current_node) == nullptr && !Compare()(key, current_node->data_)) {
+    if (next_node<Key>(current_node) == nullptr && !less(key, current_node->data_)) {
         return this->cend();
     }
-    return const_iterator(current_node);
+    return const_iterator(current_node, instrumentation_.handle());
+}
+
+// Implementation of serialization
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::save(std::ostream& os) const {
+    SerializationHeader header;
+    header.key_size = key_codec<Key>::fixed_size;
+    header.count = size_;
+    header.payload_size = serialized_size() - sizeof(SerializationHeader);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    ChunkWriter out(os);
+    for (node_type* node = minimum<Key>(root_); node != nullptr; node = next_node<Key>(node)) {
+        key_codec<Key>::write(out, node->data_);
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::save(std::span<std::byte> buffer) const {
+    if (buffer.size() < serialized_size()) {
+        return 0;
+    }
+    MemoryStreamBuffer memory(buffer);
+    std::ostream os(&memory);
+    save(os);
+    return memory.written();
+}
+
+// Keys arrive sorted, so the tree is linked directly into balanced shape without descending per key.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::load(std::istream& is) {
+    return load(is, stream_bytes_left(is));
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::load(std::span<const std::byte> buffer) {
+    MemoryStreamBuffer memory(std::span<std::byte>(const_cast<std::byte*>(buffer.data()), buffer.size()));
+    std::istream is(&memory);
+    return load(is, buffer.size());
+}
+
+// Nothing in the header is trusted: the payload must fit in what the stream holds, and the count must
+// fit in the payload, before anything is allocated. Where the stream cannot tell its length, keys are
+// stored as they are read, so memory only grows with bytes that actually arrive.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::load(std::istream& is, std::uint64_t available) {
+    SerializationHeader header;
+    if (available < sizeof(header)
+        || !is.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, SerializationHeader::kMagic, sizeof(header.magic)) != 0
+        || header.version != SerializationHeader::kVersion
+        || header.key_size != key_codec<Key>::fixed_size
+        || header.payload_size > available - sizeof(header)
+        || header.count > header.payload_size / min_encoded_size<Key>()
+        || (header.key_size != 0 && (header.payload_size % header.key_size != 0 || header.count != header.payload_size / header.key_size))) {
+        is.setstate(std::ios::failbit);
+        return false;
+    }
+
+    bool length_known = available != static_cast<std::uint64_t>(-1);
+    size_type capacity = length_known ? header.count : std::min<std::uint64_t>(header.count, 1 << 16);
+    std::unique_ptr<Key[]> keys(new Key[capacity]);
+    ChunkReader in(is, header.payload_size);
+    for (size_type i = 0; i < header.count; ++i) {
+        if (i == capacity) {
+            capacity = std::min<size_type>(capacity * 2, header.count);
+            std::unique_ptr<Key[]> grown(new Key[capacity]);
+            std::move(keys.get(), keys.get() + i, grown.get());
+            keys = std::move(grown);
+        }
+        if (!key_codec<Key>::read(in, keys[i]) || (i > 0 && less(keys[i], keys[i - 1]))) {
+            is.setstate(std::ios::failbit);
+            return false;
+        }
+    }
+
+    clear();
+    root_ = build_balanced(keys.get(), 0, header.count, nullptr);
+    size_ = header.count;
+    height_estimate_ = height();
+    max_size_ = size_;
+    recount_key_heap();
+    instrumentation_.on_allocate(size_);
+    return true;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::serialized_size() const {
+    size_type payload_size = 0;
+    if (key_codec<Key>::fixed_size != 0) {
+        payload_size = size_ * key_codec<Key>::fixed_size;
+    } else {
+        for (node_type* node = minimum<Key>(root_); node != nullptr; node = next_node<Key>(node)) {
+            payload_size += key_codec<Key>::size(node->data_);
+        }
+    }
+    return sizeof(SerializationHeader) + payload_size;
+}
+
+// Writes the image read by MappedBinarySearchTree: keys in order, linked into balanced shape by offsets.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::save_mapped(std::ostream& os) const {
+    static_assert(std::is_trivially_copyable_v<Key>, "mapped trees store keys by value");
+    // Child offsets are int32_t distances between records.
+    if (size_ > static_cast<size_type>(std::numeric_limits<std::int32_t>::max())) {
+        os.setstate(std::ios::failbit);
+        return;
+    }
+    MappedTreeHeader header;
+    header.key_size = sizeof(Key);
+    header.node_size = sizeof(MappedNode<Key>);
+    header.count = size_;
+    header.nodes_offset = (sizeof(header) + alignof(MappedNode<Key>) - 1) / alignof(MappedNode<Key>) * alignof(MappedNode<Key>);
+
+    std::unique_ptr<MappedNode<Key>[]> nodes(new MappedNode<Key>[size_]());
+    size_type index = 0;
+    for (node_type* node = minimum<Key>(root_); node != nullptr; node = next_node<Key>(node)) {
+        nodes[index++].data_ = node->data_;
+    }
+    header.root = link_mapped(nodes.get(), 0, size_);
+
+    const char padding[alignof(MappedNode<Key>)] = {};
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(padding, static_cast<std::streamsize>(header.nodes_offset - sizeof(header)));
+    os.write(reinterpret_cast<const char*>(nodes.get()), static_cast<std::streamsize>(size_ * sizeof(MappedNode<Key>)));
 }
 
+
 // Implementation of observes
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::key_compare BinarySearchTree<Key, Traversal, Compare, Allocator>::key_comp() const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::key_compare BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::key_comp() const {
     return key_compare();
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::value_compare BinarySearchTree<Key, Traversal, Compare, Allocator>::value_comp() const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::value_compare BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::value_comp() const {
     return value_compare();
 }
 
 
+// Implementation of instrumentation
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+InstrumentationStats BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::stats() const noexcept {
+    return instrumentation_.stats();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::reset_stats() noexcept {
+    instrumentation_.reset();
+}
+
+
+// Implementation of shape diagnostics
+
+// Walks the tree through parent links, so no stack is needed.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::height() const {
+    size_type height = 0;
+    size_type depth = 0;
+    node_type* previous = nullptr;
+    node_type* node = root_;
+    while (node != nullptr) {
+        node_type* next;
+        if (previous == node->parent_) {
+            height = std::max(height, depth + 1);
+            next = node->left_ != nullptr ? node->left_ : node->right_ != nullptr ? node->right_ : node->parent_.get();
+        } else if (previous == node->left_ && node->right_ != nullptr) {
+            next = node->right_;
+        } else {
+            next = node->parent_;
+        }
+        depth = next == node->parent_ ? depth - 1 : depth + 1;
+        previous = node;
+        node = next;
+    }
+    return height;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::height_estimate() const noexcept {
+    return height_estimate_;
+}
+
+// Same parent-link walk as height(), in post-order: each finished subtree leaves its height and size on a
+// stack, where its parent picks them up, so every metric comes out of a single pass.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+TreeShape BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::shape() const {
+    struct subtree_summary {
+        size_type height;
+        size_type size;
+    };
+
+    TreeShape shape;
+    size_type histogram_capacity = 0;
+    std::unique_ptr<subtree_summary[]> summaries;
+    size_type summaries_size = 0;
+    size_type summaries_capacity = 0;
+    size_type depth_sum = 0;
+
+    size_type depth = 0;
+    node_type* previous = nullptr;
+    node_type* node = root_;
+    while (node != nullptr) {
+        node_type* next;
+        if (previous == node->parent_) {
+            if (depth == histogram_capacity) {
+                size_type capacity = histogram_capacity == 0 ? 64 : histogram_capacity * 2;
+                std::unique_ptr<size_type[]> histogram(new size_type[capacity]());
+                std::copy(shape.depth_histogram.get(), shape.depth_histogram.get() + histogram_capacity, histogram.get());
+                shape.depth_histogram = std::move(histogram);
+                histogram_capacity = capacity;
+            }
+            ++shape.depth_histogram[depth];
+            ++shape.size;
+            depth_sum += depth;
+            shape.height = std::max(shape.height, depth + 1);
+            next = node->left_ != nullptr ? node->left_ : node->right_;
+        } else if (previous == node->left_) {
+            next = node->right_;
+        } else {
+            next = nullptr;
+        }
+
+        if (next != nullptr) {
+            ++depth;
+        } else {
+            subtree_summary right = node->right_ != nullptr ? summaries[--summaries_size] : subtree_summary{0, 0};
+            subtree_summary left = node->left_ != nullptr ? summaries[--summaries_size] : subtree_summary{0, 0};
+            size_type difference = left.height > right.height ? left.height - right.height : right.height - left.height;
+            shape.max_height_difference = std::max(shape.max_height_difference, difference);
+            shape.unbalanced_nodes += difference > 1;
+            if (left.size + right.size > 0) {
+                double skew = static_cast<double>(std::max(left.size, right.size) + 1) / static_cast<double>(left.size + right.size + 2);
+                shape.max_subtree_skew = std::max(shape.max_subtree_skew, skew);
+            }
+
+            if (summaries_size == summaries_capacity) {
+                size_type capacity = summaries_capacity == 0 ? 64 : summaries_capacity * 2;
+                std::unique_ptr<subtree_summary[]> grown(new subtree_summary[capacity]);
+                std::copy(summaries.get(), summaries.get() + summaries_size, grown.get());
+                summaries = std::move(grown);
+                summaries_capacity = capacity;
+            }
+            summaries[summaries_size++] = subtree_summary{std::max(left.height, right.height) + 1, left.size + right.size + 1};
+            next = node->parent_;
+            --depth;
+        }
+        previous = node;
+        node = next;
+    }
+
+    if (shape.size != 0) {
+        shape.average_depth = static_cast<double>(depth_sum) / static_cast<double>(shape.size);
+    }
+    return shape;
+}
+
+
+// Implementation of balancing
+
+// Day-Stout-Warren: right rotations straighten the tree into a vine sorted by key, then rounds of left
+// rotations along the vine fold it into a tree of minimal height. Nodes are relinked in place.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rebalance() {
+    size_type size = root_ == nullptr ? 0 : rebuild(root_);
+    height_estimate_ = std::bit_width(size);
+    max_size_ = size;
+}
+
+// With factor f, the tree is rebuilt whenever its height may exceed f times the minimal height for its size.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::set_rebalance_factor(double factor) noexcept {
+    rebalance_factor_ = factor;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+double BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rebalance_factor() const noexcept {
+    return rebalance_factor_;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+FrozenBinarySearchTree<Key, Compare> BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::freeze() const {
+    const_iterator_<Key, InOrder, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&> first(minimum<Key>(root_));
+    return FrozenBinarySearchTree<Key, Compare>(first, size_);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+VebBinarySearchTree<Key, Compare> BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::freeze(tag<VanEmdeBoas>) const {
+    const_iterator_<Key, InOrder, std::bidirectional_iterator_tag, std::ptrdiff_t, const Key*, const Key&> first(minimum<Key>(root_));
+    return VebBinarySearchTree<Key, Compare>(first, size_);
+}
+
+// Every node gets a slot in key order and leaves its new address in its old left_, through which the
+// links copied into the new nodes are then translated.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::compact() {
+    if (size_ == 0) {
+        return;
+    }
+    std::unique_ptr<node_type*[]> old_nodes(new node_type*[size_]);
+    size_type count = 0;
+    node_type* node = root_;
+    while (node->left_ != nullptr) {
+        node = node->left_;
+    }
+    while (node != nullptr) {
+        old_nodes[count++] = node;
+        if (node->right_ != nullptr) {
+            node = node->right_;
+            while (node->left_ != nullptr) {
+                node = node->left_;
+            }
+        } else {
+            while (node->parent_ != nullptr && node->parent_->right_ == node) {
+                node = node->parent_;
+            }
+            node = node->parent_;
+        }
+    }
+
+    node_type* nodes = pool_.allocate_block(size_);
+    instrumentation_.on_allocate(size_);
+    for (size_type i = 0; i < size_; ++i) {
+        track_key(old_nodes[i]->data_, false);
+        node = new (nodes + i) node_type(std::move(old_nodes[i]->data_), nullptr);
+        track_key(node->data_, true);
+        node->parent_ = old_nodes[i]->parent_;
+        node->left_ = old_nodes[i]->left_;
+        node->right_ = old_nodes[i]->right_;
+    }
+    for (size_type i = 0; i < size_; ++i) {
+        old_nodes[i]->left_ = nodes + i;
+    }
+    auto relocated = [](node_type* node) { return node == nullptr ? nullptr : node->left_; };
+    for (size_type i = 0; i < size_; ++i) {
+        nodes[i].left_ = relocated(nodes[i].left_);
+        nodes[i].right_ = relocated(nodes[i].right_);
+        nodes[i].parent_ = relocated(nodes[i].parent_);
+    }
+    root_ = relocated(root_);
+
+    for (size_type i = 0; i < size_; ++i) {
+        pool_.destroy(old_nodes[i]);
+    }
+    pool_.shrink_to_fit();
+    instrumentation_.on_deallocate(size_);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::set_huge_pages(bool enable) noexcept {
+    pool_.set_huge_pages(enable);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::huge_pages() const noexcept {
+    return pool_.huge_pages();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::mapped_bytes(PageBacking backing) const noexcept {
+    return pool_.mapped_bytes(backing);
+}
+
+
 // Implementation of private functions
 
-template<class Key, class Traversal, class Compare, class Allocator>
-BinarySearchTree<Key, Traversal, Compare, Allocator>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator>::find_node(const Key& key) const {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+bool BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::less(const Key& lhs, const Key& rhs) const {
+    instrumentation_.on_compare();
+    return Compare()(lhs, rhs);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::find_node(const Key& key) const {
     if (root_ == nullptr) {
         return nullptr;
     }
 
     node_type* current_node = root_;
+    instrumentation_.on_descent();
     while (current_node != nullptr && current_node->data_ != key) {
-        if (Compare()(current_node->data_,key)) {
+        instrumentation_.on_visit();
+        if (less(current_node->data_, key)) {
             current_node = current_node->right_;
         } else {
             current_node = current_node->left_;
@@ -754,8 +1353,8 @@ BinarySearchTree<Key, Traversal, Compare, Allocator>::node_type* BinarySearchTre
     return current_node;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::erase(node_type*& root, node_type*& erased_node) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::erase(node_type*& root, node_type*& erased_node) {
     if (erased_node == nullptr || root == nullptr) {
         return;
     }
@@ -807,8 +1406,8 @@ void BinarySearchTree<Key, Traversal, Compare, Allocator>::erase(node_type*& roo
     --size_;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::swap(BinarySearchTree::node_type *node_1, BinarySearchTree::node_type *node_2) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::swap(BinarySearchTree::node_type *node_1, BinarySearchTree::node_type *node_2) {
     node_type* left_node_1 = node_1->left_;
     node_type* right_node_1 = node_1->right_;
     node_type* parent_node_1 = node_1->parent_;
@@ -927,6 +1526,130 @@ void BinarySearchTree<Key, Traversal, Compare, Allocator>::swap(BinarySearchTree
     node_1->right_ = right_node_2;
 }
 
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert_node(node_type*& subtree_root, node_type* parent, const value_type& value, size_type& depth, node_type* storage) {
+    instrumentation_.on_descent();
+    instrumentation_.on_allocate();
+    // Parallel batches count their keys once the workers are done.
+    auto create = [this, storage, &value](node_type* parent) {
+        if (storage != nullptr) {
+            return new (storage) node_type(value, parent);
+        }
+        node_type* node = pool_.create(value, parent);
+        track_key(node->data_, true);
+        return node;
+    };
+    if (subtree_root == nullptr) {
+        subtree_root = create(parent);
+        return subtree_root;
+    }
+    node_type* current_node = subtree_root;
+    while (true) {
+        instrumentation_.on_visit();
+        ++depth;
+        if (less(current_node->data_, value)) {
+            if (current_node->right_ == nullptr) {
+                current_node->right_ = create(current_node);
+                return current_node->right_;
+            }
+            current_node = current_node->right_;
+        } else {
+            if (current_node->left_ == nullptr) {
+                current_node->left_ = create(current_node);
+                return current_node->left_;
+            }
+            current_node = current_node->left_;
+        }
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::sort_batch(Key* keys, size_type n, unsigned threads) {
+    if (threads <= 1) {
+        std::sort(keys, keys + n, Compare());
+        return;
+    }
+    std::unique_ptr<size_type[]> bounds(new size_type[threads + 1]);
+    for (unsigned i = 0; i <= threads; ++i) {
+        bounds[i] = n * i / threads;
+    }
+    std::unique_ptr<std::thread[]> pool(new std::thread[threads]);
+    for (unsigned i = 0; i < threads; ++i) {
+        pool[i] = std::thread([keys, &bounds, i]() {
+            std::sort(keys + bounds[i], keys + bounds[i + 1], Compare());
+        });
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        pool[i].join();
+    }
+    for (unsigned width = 1; width < threads; width *= 2) {
+        unsigned merges = 0;
+        for (unsigned i = 0; i + width < threads; i += 2 * width) {
+            size_type first = bounds[i];
+            size_type middle = bounds[i + width];
+            size_type last = bounds[std::min(i + 2 * width, threads)];
+            pool[merges++] = std::thread([keys, first, middle, last]() {
+                std::inplace_merge(keys + first, keys + middle, keys + last, Compare());
+            });
+        }
+        for (unsigned i = 0; i < merges; ++i) {
+            pool[i].join();
+        }
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::split_batch(node_type** slot, node_type* parent, const Key* first, const Key* last, unsigned depth, batch_task* tasks, size_type& task_count) {
+    if (first == last) {
+        return;
+    }
+    node_type* node = *slot;
+    if (depth == 0 || node == nullptr) {
+        tasks[task_count++] = batch_task{slot, parent, first, last, 0};
+        return;
+    }
+    const Key* middle = std::upper_bound(first, last, node->data_, Compare());
+    split_batch(&node->left_, node, first, middle, depth - 1, tasks, task_count);
+    split_batch(&node->right_, node, middle, last, depth - 1, tasks, task_count);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::insert_sorted(node_type*& subtree_root, node_type* parent, const Key* first, const Key* last, size_type depth, size_type& height, node_type* storage) {
+    if (first == last) {
+        return;
+    }
+    const Key* middle = first + (last - first) / 2;
+    size_type node_depth = depth;
+    insert_node(subtree_root, parent, *middle, node_depth, storage == nullptr ? nullptr : storage + (middle - first));
+    height = std::max(height, node_depth + 1);
+    insert_sorted(subtree_root, parent, first, middle, depth, height, storage);
+    insert_sorted(subtree_root, parent, middle + 1, last, depth, height, storage == nullptr ? nullptr : storage + (middle + 1 - first));
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::build_balanced(Key* keys, size_type first, size_type last, node_type* parent) {
+    if (first >= last) {
+        return nullptr;
+    }
+    size_type middle = first + (last - first) / 2;
+    node_type* node = new node_type(std::move(keys[middle]), parent);
+    node->left_ = build_balanced(keys, first, middle, node);
+    node->right_ = build_balanced(keys, middle + 1, last, node);
+    return node;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::link_mapped(MappedNode<Key>* nodes, size_type first, size_type last) {
+    size_type middle = first + (last - first) / 2;
+    if (first < middle) {
+        nodes[middle].left_ = static_cast<std::int32_t>(link_mapped(nodes, first, middle) - middle);
+    }
+    if (middle + 1 < last) {
+        nodes[middle].right_ = static_cast<std::int32_t>(link_mapped(nodes, middle + 1, last) - middle);
+    }
+    return middle;
+}
+
 template<class Key>
 BinarySearchTree<Key>::node_type* minimum(typename BinarySearchTree<Key>::node_type* subtree_root) {
     if (subtree_root == nullptr) {
@@ -981,8 +1704,212 @@ BinarySearchTree<Key>::node_type* prev_node(typename BinarySearchTree<Key>::node
     return parent;
 }
 
-template<class Key, class Traversal, class Compare, class Allocator>
-void BinarySearchTree<Key, Traversal, Compare, Allocator>::delete_children(node_type* node) {
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::replace_child(node_type* parent, node_type* old_child, node_type* new_child) const {
+    if (parent == nullptr) {
+        root_ = new_child;
+    } else if (parent->left_ == old_child) {
+        parent->left_ = new_child;
+    } else {
+        parent->right_ = new_child;
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rotate_left(node_type* node) const {
+    node_type* pivot = node->right_;
+    node->right_ = pivot->left_;
+    if (pivot->left_ != nullptr) {
+        pivot->left_->parent_ = node;
+    }
+    pivot->parent_ = node->parent_;
+    replace_child(node->parent_, node, pivot);
+    pivot->left_ = node;
+    node->parent_ = pivot;
+    instrumentation_.on_rotate();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rotate_right(node_type* node) const {
+    node_type* pivot = node->left_;
+    node->left_ = pivot->right_;
+    if (pivot->right_ != nullptr) {
+        pivot->right_->parent_ = node;
+    }
+    pivot->parent_ = node->parent_;
+    replace_child(node->parent_, node, pivot);
+    pivot->right_ = node;
+    node->parent_ = pivot;
+    instrumentation_.on_rotate();
+}
+
+// Left-rotates every other node of the right spine starting at top, count times, and returns the new top.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::node_type* BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::compress(node_type* top, size_type count) {
+    node_type* node = top;
+    for (size_type i = 0; i < count; ++i) {
+        node_type* pivot = node->right_;
+        rotate_left(node);
+        if (i == 0) {
+            top = pivot;
+        }
+        node = pivot->right_;
+    }
+    return top;
+}
+
+// Rebuilds the subtree under top into minimal height in place and returns its size.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rebuild(node_type* top) {
+    size_type size = 0;
+    node_type* node = top;
+    while (node != nullptr) {
+        if (node->left_ != nullptr) {
+            node_type* pivot = node->left_;
+            rotate_right(node);
+            if (node == top) {
+                top = pivot;
+            }
+            node = pivot;
+        } else {
+            ++size;
+            node = node->right_;
+        }
+    }
+
+    size_type perfect_size = (size_type(1) << (std::bit_width(size + 1) - 1)) - 1;
+    top = compress(top, size - perfect_size);
+    for (size_type count = perfect_size / 2; count > 0; count /= 2) {
+        top = compress(top, count);
+    }
+    return size;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::size_type BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::subtree_size(node_type* top) {
+    if (top == nullptr) {
+        return 0;
+    }
+    size_type size = 0;
+    node_type* previous = top->parent_;
+    node_type* node = top;
+    while (true) {
+        node_type* next;
+        if (previous == node->parent_) {
+            ++size;
+            next = node->left_ != nullptr ? node->left_ : node->right_ != nullptr ? node->right_ : node->parent_.get();
+        } else if (previous == node->left_ && node->right_ != nullptr) {
+            next = node->right_;
+        } else {
+            next = node->parent_;
+        }
+        if (node == top && next == top->parent_) {
+            return size;
+        }
+        previous = node;
+        node = next;
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_insert(node_type*, size_type, tag<Unbalanced>) {}
+
+// Scapegoat with alpha = 2/3: an insert deeper than log_{3/2}(size) rebuilds the lowest ancestor that holds
+// more than two thirds of its subtree in one child. node is nullptr after insert_batch, where only the
+// height estimate is known, and then the whole tree is rebuilt.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_insert(node_type* node, size_type depth, tag<Scapegoat>) {
+    max_size_ = std::max(max_size_, size_);
+    if (static_cast<double>(depth) <= std::log(static_cast<double>(size_)) / std::log(1.5)) {
+        return;
+    }
+    if (node == nullptr) {
+        rebalance();
+        return;
+    }
+    size_type child_size = 1;
+    for (node_type* child = node; child->parent_ != nullptr; child = child->parent_) {
+        node_type* parent = child->parent_;
+        size_type parent_size = child_size + 1 + subtree_size(parent->left_ == child ? parent->right_ : parent->left_);
+        if (3 * child_size > 2 * parent_size) {
+            rebuild(parent);
+            return;
+        }
+        child_size = parent_size;
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_erase(tag<Unbalanced>) {}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_erase(tag<Scapegoat>) {
+    if (3 * size_ < 2 * max_size_) {
+        rebalance();
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_insert(node_type* node, size_type, tag<Splay>) {
+    if (node != nullptr) {
+        splay(node);
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_erase(tag<Splay>) {}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_access(node_type*, tag<Unbalanced>) const {}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_access(node_type*, tag<Scapegoat>) const {}
+
+// Splaying rewires only the separately allocated nodes and the mutable root_, so the rotations are
+// const members and a const lookup calls them directly.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::after_access(node_type* node, tag<Splay>) const {
+    if (node != nullptr) {
+        splay(node);
+    }
+}
+
+// Bottom-up splay: zig-zig rotates the grandparent first, zig-zag the parent first.
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::splay(node_type* node) const {
+    while (node->parent_ != nullptr) {
+        node_type* parent = node->parent_;
+        node_type* grandparent = parent->parent_;
+        bool left_child = parent->left_ == node;
+        if (grandparent == nullptr) {
+            left_child ? rotate_right(parent) : rotate_left(parent);
+        } else if (left_child == (grandparent->left_ == parent)) {
+            left_child ? rotate_right(grandparent) : rotate_left(grandparent);
+            left_child ? rotate_right(parent) : rotate_left(parent);
+        } else {
+            left_child ? rotate_right(parent) : rotate_left(parent);
+            left_child ? rotate_left(grandparent) : rotate_right(grandparent);
+        }
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::rebalance_if_degraded() {
+    double limit = rebalance_factor_ * static_cast<double>(std::bit_width(size_));
+    if (rebalance_factor_ <= 0 || static_cast<double>(height_estimate_) <= limit) {
+        return;
+    }
+    // The estimate only grows, so check the real height before paying for a rebuild.
+    size_type exact_height = height();
+    if (static_cast<double>(exact_height) > limit) {
+        rebalance();
+    } else {
+        height_estimate_ = exact_height;
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::delete_children(node_type* node) {
     if (node->left_ != nullptr) {
         delete_children(node->left_);
     }
@@ -990,5 +1917,49 @@ void BinarySearchTree<Key, Traversal, Compare, Allocator>::delete_children(node_
         delete_children(node->right_);
     }
 
-    delete node;
+    destroy_node(node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::destroy_node(node_type* node) {
+    track_key(node->data_, false);
+    pool_.destroy(node);
+    instrumentation_.on_deallocate();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::track_key(const Key& key, bool added) {
+    size_type bytes = key_heap_usage<Key>::bytes(key);
+    if (bytes == 0) {
+        return;
+    }
+    if (added) {
+        key_heap_bytes_ += bytes;
+        key_heap_overhead_ += heap_overhead(bytes);
+    } else {
+        key_heap_bytes_ -= bytes;
+        key_heap_overhead_ -= heap_overhead(bytes);
+    }
+}
+
+// Pre-order parent-link walk, as in shape().
+template<class Key, class Traversal, class Compare, class Allocator, class Instrumentation, class Balance>
+void BinarySearchTree<Key, Traversal, Compare, Allocator, Instrumentation, Balance>::recount_key_heap() {
+    key_heap_bytes_ = 0;
+    key_heap_overhead_ = 0;
+    node_type* previous = nullptr;
+    node_type* node = root_;
+    while (node != nullptr) {
+        node_type* next;
+        if (previous == node->parent_) {
+            track_key(node->data_, true);
+            next = node->left_ != nullptr ? node->left_ : node->right_ != nullptr ? node->right_ : node->parent_.get();
+        } else if (previous == node->left_ && node->right_ != nullptr) {
+            next = node->right_;
+        } else {
+            next = node->parent_;
+        }
+        previous = node;
+        node = next;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,635 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "NodeAlgorithms.h"
+#include "tag.cpp"
+
+// Slot of the node arena. Links are indices into the arena; a slot on the free list has no key and
+// chains to the next free slot through left_.
+template<typename T>
+struct CompactNode {
+    static constexpr std::uint32_t kNil = 0xFFFFFFFF;
+    static constexpr std::uint32_t kFree = 0xFFFFFFFE;
+
+    CompactNode() {}
+    CompactNode(std::uint32_t left, std::uint32_t right, std::uint32_t parent) : left_(left), right_(right), parent_(parent) {}
+    ~CompactNode() {}
+
+    union {
+        T data_;
+    };
+    std::uint32_t left_ = kNil;
+    std::uint32_t right_ = kNil;
+    std::uint32_t parent_ = kNil;
+};
+
+// Unbalanced binary search tree with the interface of BinarySearchTree whose nodes live in one growable
+// array and link to each other by 32-bit indices: a node of int keys takes 16 bytes instead of 32 plus
+// the allocator's header. Erased slots are reused before the arena grows. Iterators hold indices, so
+// they stay valid across inserts; references and pointers to keys do not. Holds at most 2^32 - 2 keys.
+// Iterators walk in Traversal order; lookups and erase(key) always go by key order.
+template<class Key, class Traversal = InOrder, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class CompactBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Allocator allocator_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef CompactNode<Key> node_type;
+    typedef std::uint32_t index_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef const_reverse_iterator reverse_iterator;
+
+    CompactBinarySearchTree() = default;
+    explicit CompactBinarySearchTree(const Allocator& alloc);
+    template<class InputIt>
+    CompactBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    CompactBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+    CompactBinarySearchTree(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other);
+    CompactBinarySearchTree(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>&& other) noexcept;
+    ~CompactBinarySearchTree();
+
+    CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& operator=(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other);
+    CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& operator=(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>&& other) noexcept;
+    CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& operator=(std::initializer_list<value_type> ilist);
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+    const_reverse_iterator rbegin() const noexcept;
+    const_reverse_iterator rend() const noexcept;
+    const_reverse_iterator crbegin() const noexcept;
+    const_reverse_iterator crend() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] size_type max_size() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    iterator insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const Key& key);
+    void swap(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+    bool operator==(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) const;
+    bool operator!=(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<node_type> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    typedef ArenaLinks<node_type> links_type;
+    typedef NodeAlgorithms<links_type> algorithms;
+
+    static constexpr index_type kNil = node_type::kNil;
+    static constexpr index_type kFree = node_type::kFree;
+    static constexpr index_type kInitialCapacity = 16;
+
+    node_type* nodes_ = nullptr;
+    index_type capacity_ = 0;
+    // Slots below used_ have been handed out at least once; the rest of the arena is raw storage.
+    index_type used_ = 0;
+    index_type free_ = kNil;
+    index_type root_ = kNil;
+    size_type size_ = 0;
+    [[no_unique_address]] node_allocator node_allocator_;
+
+    links_type links() const noexcept { return links_type{nodes_}; }
+
+    // Steps of the Traversal walk; kNil is the end position, so prev(kNil) is the last node.
+    index_type first(tag<InOrder>) const;
+    index_type first(tag<PreOrder>) const;
+    index_type first(tag<PostOrder>) const;
+    index_type next(index_type node, tag<InOrder>) const;
+    index_type next(index_type node, tag<PreOrder>) const;
+    index_type next(index_type node, tag<PostOrder>) const;
+    index_type prev(index_type node, tag<InOrder>) const;
+    index_type prev(index_type node, tag<PreOrder>) const;
+    index_type prev(index_type node, tag<PostOrder>) const;
+
+    index_type make_node(const value_type& value, index_type parent);
+    void grow();
+    void release_arena() noexcept;
+};
+
+template<class Key, class Traversal, class Compare, class Allocator>
+class CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>* tree, index_type index) : tree_(tree), index_(index) {}
+
+    reference operator*() const { return tree_->nodes_[index_].data_; }
+    pointer operator->() const { return &tree_->nodes_[index_].data_; }
+
+    const_iterator& operator++() {
+        index_ = tree_->next(index_, tag<Traversal>{});
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        index_ = tree_->prev(index_, tag<Traversal>{});
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+    bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    index_type index() const { return index_; }
+
+private:
+    const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>* tree_ = nullptr;
+    index_type index_ = kNil;
+};
+
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::CompactBinarySearchTree(const Allocator& alloc) : node_allocator_(alloc) {}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+template<class InputIt>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::CompactBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : CompactBinarySearchTree<Key, Traversal, Compare, Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::CompactBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : CompactBinarySearchTree<Key, Traversal, Compare, Allocator>(init.begin(), init.end(), alloc) {}
+
+// Copies the arena slot by slot, so the copy keeps the same indices and free list.
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::CompactBinarySearchTree(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other)
+        : node_allocator_(node_traits::select_on_container_copy_construction(other.node_allocator_)) {
+    if (other.used_ == 0) {
+        return;
+    }
+    nodes_ = node_traits::allocate(node_allocator_, other.used_);
+    capacity_ = other.used_;
+    for (; used_ < other.used_; ++used_) {
+        const node_type& source = other.nodes_[used_];
+        node_traits::construct(node_allocator_, nodes_ + used_, source.left_, source.right_, source.parent_);
+        if (source.parent_ != kFree) {
+            std::construct_at(&nodes_[used_].data_, source.data_);
+        }
+    }
+    free_ = other.free_;
+    root_ = other.root_;
+    size_ = other.size_;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::CompactBinarySearchTree(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>&& other) noexcept
+        : node_allocator_(other.node_allocator_) {
+    swap(other);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::~CompactBinarySearchTree() {
+    release_arena();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::operator=(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other) {
+    if (this != &other) {
+        CompactBinarySearchTree<Key, Traversal, Compare, Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::operator=(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::operator=(std::initializer_list<value_type> ilist) {
+    clear();
+    insert(ilist);
+    return *this;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::allocator_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::get_allocator() const noexcept {
+    return allocator_type(node_allocator_);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::begin() const noexcept {
+    return const_iterator(this, first(tag<Traversal>{}));
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::end() const noexcept {
+    return const_iterator(this, kNil);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::cbegin() const noexcept {
+    return begin();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::cend() const noexcept {
+    return end();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::rbegin() const noexcept {
+    return const_reverse_iterator(end());
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::rend() const noexcept {
+    return const_reverse_iterator(begin());
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::crbegin() const noexcept {
+    return rbegin();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_reverse_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::crend() const noexcept {
+    return rend();
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Traversal, class Compare, class Allocator>
+bool CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::size_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::size_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::max_size() const noexcept {
+    return kFree;
+}
+
+
+// Implementation of modifiers
+
+// Keeps the arena; its slots all go to the free list.
+template<class Key, class Traversal, class Compare, class Allocator>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::clear() noexcept {
+    free_ = kNil;
+    for (index_type i = used_; i-- > 0;) {
+        if (nodes_[i].parent_ != kFree) {
+            std::destroy_at(&nodes_[i].data_);
+            nodes_[i].parent_ = kFree;
+        }
+        nodes_[i].left_ = free_;
+        free_ = i;
+    }
+    root_ = kNil;
+    size_ = 0;
+}
+
+// Equal keys are inserted before the existing ones, as in BinarySearchTree.
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::insert(const value_type& value) {
+    index_type parent = kNil;
+    bool right = false;
+    for (index_type node = root_; node != kNil;) {
+        parent = node;
+        right = Compare()(nodes_[node].data_, value);
+        node = right ? nodes_[node].right_ : nodes_[node].left_;
+    }
+    index_type node = make_node(value, parent);
+    if (parent == kNil) {
+        root_ = node;
+    } else if (right) {
+        nodes_[parent].right_ = node;
+    } else {
+        nodes_[parent].left_ = node;
+    }
+    ++size_;
+    return iterator(this, node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+template<class InputIt>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+// Relinks rather than moving keys between slots, so iterators to other keys stay valid.
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::erase(const_iterator pos) {
+    index_type node = pos.index();
+    index_type following = next(node, tag<Traversal>{});
+    algorithms::unlink(links(), root_, node);
+
+    node_type& erased = nodes_[node];
+    std::destroy_at(&erased.data_);
+    erased.parent_ = kFree;
+    erased.left_ = free_;
+    free_ = node;
+    --size_;
+    return iterator(this, following);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+        first = erase(first);
+    }
+    return iterator(this, last.index());
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::size_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::erase(const Key& key) {
+    size_type count = 0;
+    index_type node = lower_bound(key).index();
+    while (node != kNil && !Compare()(key, nodes_[node].data_)) {
+        index_type following = algorithms::successor(links(), node);
+        erase(const_iterator(this, node));
+        node = following;
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::swap(CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& other) noexcept {
+    std::swap(nodes_, other.nodes_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(used_, other.used_);
+    std::swap(free_, other.free_);
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(node_allocator_, other.node_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::size_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::count(const Key& key) const {
+    size_type count = 0;
+    for (index_type node = lower_bound(key).index(); node != kNil && !Compare()(key, nodes_[node].data_); node = algorithms::successor(links(), node)) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::find(const Key& key) const {
+    index_type node = root_;
+    while (node != kNil) {
+        bool right = Compare()(nodes_[node].data_, key);
+        if (!right && !Compare()(key, nodes_[node].data_)) {
+            break;
+        }
+        node = right ? nodes_[node].right_ : nodes_[node].left_;
+    }
+    return const_iterator(this, node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+bool CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+std::pair<typename CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator, typename CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator> CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::lower_bound(const Key& key) const {
+    index_type result = kNil;
+    for (index_type node = root_; node != kNil;) {
+        bool right = Compare()(nodes_[node].data_, key);
+        result = right ? result : node;
+        node = right ? nodes_[node].right_ : nodes_[node].left_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::const_iterator CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::upper_bound(const Key& key) const {
+    index_type result = kNil;
+    for (index_type node = root_; node != kNil;) {
+        bool left = Compare()(key, nodes_[node].data_);
+        result = left ? node : result;
+        node = left ? nodes_[node].left_ : nodes_[node].right_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::key_compare CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::key_comp() const {
+    return Compare();
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::value_compare CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::value_comp() const {
+    return Compare();
+}
+
+// Compares the keys in key order, whatever the traversal.
+template<class Key, class Traversal, class Compare, class Allocator>
+bool CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::operator==(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) const {
+    if (size_ != rhs.size_) {
+        return false;
+    }
+    index_type node = algorithms::minimum(links(), root_);
+    index_type other = algorithms::minimum(rhs.links(), rhs.root_);
+    for (; node != kNil; node = algorithms::successor(links(), node), other = algorithms::successor(rhs.links(), other)) {
+        if (!(nodes_[node].data_ == rhs.nodes_[other].data_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+bool CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::operator!=(const CompactBinarySearchTree<Key, Traversal, Compare, Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::first(tag<InOrder>) const {
+    return algorithms::minimum(links(), root_);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::first(tag<PreOrder>) const {
+    return root_;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::first(tag<PostOrder>) const {
+    return algorithms::postorder_first(links(), root_);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::next(index_type node, tag<InOrder>) const {
+    return algorithms::successor(links(), node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::next(index_type node, tag<PreOrder>) const {
+    return algorithms::preorder_successor(links(), node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::next(index_type node, tag<PostOrder>) const {
+    return algorithms::postorder_successor(links(), node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::prev(index_type node, tag<InOrder>) const {
+    return node == kNil ? algorithms::maximum(links(), root_) : algorithms::predecessor(links(), node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::prev(index_type node, tag<PreOrder>) const {
+    return node == kNil ? algorithms::preorder_last(links(), root_) : algorithms::preorder_predecessor(links(), node);
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::prev(index_type node, tag<PostOrder>) const {
+    return node == kNil ? root_ : algorithms::postorder_predecessor(links(), node);
+}
+
+// Takes a slot from the free list, or the next untouched one, growing the arena when both run out.
+// Indices from kFree up are reserved, so an arena of max_size() slots cannot grow. The slot is
+// committed only once the key is copied, so a throwing copy leaves the tree as it was.
+template<class Key, class Traversal, class Compare, class Allocator>
+CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::index_type CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::make_node(const value_type& value, index_type parent) {
+    index_type node;
+    if (free_ != kNil) {
+        node = free_;
+        std::construct_at(&nodes_[node].data_, value);
+        free_ = nodes_[node].left_;
+        nodes_[node].left_ = kNil;
+        nodes_[node].right_ = kNil;
+    } else {
+        if (used_ == kFree) {
+            throw std::length_error("CompactBinarySearchTree: max_size() exceeded");
+        }
+        if (used_ == capacity_) {
+            grow();
+        }
+        node = used_;
+        node_traits::construct(node_allocator_, nodes_ + node);
+        try {
+            std::construct_at(&nodes_[node].data_, value);
+        } catch (...) {
+            node_traits::destroy(node_allocator_, nodes_ + node);
+            throw;
+        }
+        ++used_;
+    }
+    nodes_[node].parent_ = parent;
+    return node;
+}
+
+// Only called with an empty free list, so every slot below used_ holds a key.
+template<class Key, class Traversal, class Compare, class Allocator>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::grow() {
+    index_type capacity = capacity_ == 0 ? kInitialCapacity : static_cast<index_type>(std::min<size_type>(2 * size_type(capacity_), kFree));
+    node_type* nodes = node_traits::allocate(node_allocator_, capacity);
+    for (index_type i = 0; i < used_; ++i) {
+        node_traits::construct(node_allocator_, nodes + i, nodes_[i].left_, nodes_[i].right_, nodes_[i].parent_);
+        std::construct_at(&nodes[i].data_, std::move(nodes_[i].data_));
+        std::destroy_at(&nodes_[i].data_);
+        node_traits::destroy(node_allocator_, nodes_ + i);
+    }
+    if (nodes_ != nullptr) {
+        node_traits::deallocate(node_allocator_, nodes_, capacity_);
+    }
+    nodes_ = nodes;
+    capacity_ = capacity;
+}
+
+template<class Key, class Traversal, class Compare, class Allocator>
+void CompactBinarySearchTree<Key, Traversal, Compare, Allocator>::release_arena() noexcept {
+    if (nodes_ == nullptr) {
+        return;
+    }
+    clear();
+    for (index_type i = 0; i < used_; ++i) {
+        node_traits::destroy(node_allocator_, nodes_ + i);
+    }
+    node_traits::deallocate(node_allocator_, nodes_, capacity_);
+    nodes_ = nullptr;
+    capacity_ = 0;
+    used_ = 0;
+    free_ = kNil;
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Immutable snapshot returned by BinarySearchTree::freeze(). Keys are stored in one array in Eytzinger
+// (breadth-first) order: keys_[1] is the root and the children of keys_[k] are keys_[2k] and keys_[2k + 1].
+// A search is a loop of k = 2k + (key goes right) with no data-dependent branch, and the descendants
+// four levels down are prefetched while the current level is compared. Index 0 is unused and stands for end().
+template<class Key, class Compare = std::less<Key>>
+class FrozenBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef const value_type& const_reference;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    FrozenBinarySearchTree() = default;
+    // Builds the layout from `count` keys read in sorted order from `first`.
+    template<class InputIt>
+    FrozenBinarySearchTree(InputIt first, size_type count);
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+
+private:
+    // The 16 descendants four levels below k are contiguous from 16k; for keys of up to 4 bytes they fill one line.
+    static constexpr size_type kPrefetchLevels = 4;
+
+    std::unique_ptr<Key[]> keys_;
+    size_type size_ = 0;
+
+    template<class InputIt>
+    void place(size_type k, InputIt& it);
+    void prefetch(size_type k) const;
+    // Undoes the trailing right turns of a finished descent, yielding the last node where it went left.
+    static size_type last_left_turn(size_type k);
+};
+
+// Steps through the implicit tree in order by index arithmetic alone.
+template<class Key, class Compare>
+class FrozenBinarySearchTree<Key, Compare>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const FrozenBinarySearchTree<Key, Compare>* tree, size_type index) : tree_(tree), index_(index) {}
+
+    reference operator*() const { return tree_->keys_[index_]; }
+    pointer operator->() const { return &tree_->keys_[index_]; }
+
+    const_iterator& operator++() {
+        size_type n = tree_->size_;
+        if (2 * index_ + 1 <= n) {
+            index_ = 2 * index_ + 1;
+            while (2 * index_ <= n) {
+                index_ *= 2;
+            }
+        } else {
+            index_ >>= std::countr_one(index_) + 1;
+        }
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        size_type n = tree_->size_;
+        if (index_ == 0) {
+            index_ = 1;
+            while (2 * index_ + 1 <= n) {
+                index_ = 2 * index_ + 1;
+            }
+        } else if (2 * index_ <= n) {
+            index_ *= 2;
+            while (2 * index_ + 1 <= n) {
+                index_ = 2 * index_ + 1;
+            }
+        } else {
+            index_ >>= std::countr_zero(index_) + 1;
+        }
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+    bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    size_type index() const { return index_; }
+
+private:
+    const FrozenBinarySearchTree<Key, Compare>* tree_ = nullptr;
+    size_type index_ = 0;
+};
+
+
+template<class Key, class Compare>
+template<class InputIt>
+FrozenBinarySearchTree<Key, Compare>::FrozenBinarySearchTree(InputIt first, size_type count) : keys_(new Key[count + 1]), size_(count) {
+    place(1, first);
+}
+
+// An in-order walk of the implicit tree visits the slots in key order, so it consumes the sorted input directly.
+template<class Key, class Compare>
+template<class InputIt>
+void FrozenBinarySearchTree<Key, Compare>::place(size_type k, InputIt& it) {
+    if (k > size_) {
+        return;
+    }
+    place(2 * k, it);
+    keys_[k] = *it;
+    ++it;
+    place(2 * k + 1, it);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::const_iterator FrozenBinarySearchTree<Key, Compare>::begin() const noexcept {
+    if (size_ == 0) {
+        return end();
+    }
+    return const_iterator(this, size_type(1) << (std::bit_width(size_) - 1));
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::const_iterator FrozenBinarySearchTree<Key, Compare>::end() const noexcept {
+    return const_iterator(this, 0);
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare>
+bool FrozenBinarySearchTree<Key, Compare>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::size_type FrozenBinarySearchTree<Key, Compare>::size() const noexcept {
+    return size_;
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::size_type FrozenBinarySearchTree<Key, Compare>::count(const Key& key) const {
+    size_type count = 0;
+    const_iterator last = upper_bound(key);
+    for (const_iterator it = lower_bound(key); it != last; ++it) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::const_iterator FrozenBinarySearchTree<Key, Compare>::find(const Key& key) const {
+    const_iterator it = lower_bound(key);
+    if (it != end() && !Compare()(key, *it)) {
+        return it;
+    }
+    return end();
+}
+
+template<class Key, class Compare>
+bool FrozenBinarySearchTree<Key, Compare>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<class Key, class Compare>
+std::pair<typename FrozenBinarySearchTree<Key, Compare>::const_iterator, typename FrozenBinarySearchTree<Key, Compare>::const_iterator> FrozenBinarySearchTree<Key, Compare>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::const_iterator FrozenBinarySearchTree<Key, Compare>::lower_bound(const Key& key) const {
+    size_type k = 1;
+    while (k <= size_) {
+        prefetch(k);
+        k = 2 * k + Compare()(keys_[k], key);
+    }
+    return const_iterator(this, last_left_turn(k));
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::const_iterator FrozenBinarySearchTree<Key, Compare>::upper_bound(const Key& key) const {
+    size_type k = 1;
+    while (k <= size_) {
+        prefetch(k);
+        k = 2 * k + !Compare()(key, keys_[k]);
+    }
+    return const_iterator(this, last_left_turn(k));
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::key_compare FrozenBinarySearchTree<Key, Compare>::key_comp() const {
+    return Compare();
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Compare>
+void FrozenBinarySearchTree<Key, Compare>::prefetch(size_type k) const {
+#if defined(__GNUC__)
+    size_type descendant = k << kPrefetchLevels;
+    if (descendant <= size_) {
+        __builtin_prefetch(keys_.get() + descendant);
+    }
+#endif
+}
+
+template<class Key, class Compare>
+FrozenBinarySearchTree<Key, Compare>::size_type FrozenBinarySearchTree<Key, Compare>::last_left_turn(size_type k) {
+    return k >> (std::countr_one(k) + 1);
+}
@@ -0,0 +1,58 @@
+#include "HugePages.h"
+
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define BINARY_SEARCH_TREE_HAS_MMAP 1
+#endif
+
+PageRegion map_huge_pages(std::size_t bytes) noexcept {
+    PageRegion region;
+#ifdef BINARY_SEARCH_TREE_HAS_MMAP
+    std::size_t size = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (size == 0) {
+        return region;
+    }
+#ifdef MAP_HUGETLB
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+        return PageRegion{data, size, PageBacking::Explicit};
+    }
+#endif
+    // Over-map by one huge page and trim both ends, so that the kernel can back the region with whole huge pages.
+    void* raw = ::mmap(nullptr, size + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return region;
+    }
+    auto begin = reinterpret_cast<std::uintptr_t>(raw);
+    auto aligned = (begin + kHugePageSize - 1) & ~std::uintptr_t(kHugePageSize - 1);
+    if (aligned != begin) {
+        ::munmap(raw, aligned - begin);
+    }
+    std::size_t tail = begin + size + kHugePageSize - (aligned + size);
+    if (tail != 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+    region.data = reinterpret_cast<void*>(aligned);
+    region.size = size;
+#ifdef MADV_HUGEPAGE
+    if (::madvise(region.data, size, MADV_HUGEPAGE) == 0) {
+        region.backing = PageBacking::Transparent;
+    }
+#endif
+#else
+    (void)bytes;
+#endif
+    return region;
+}
+
+void unmap_pages(const PageRegion& region) noexcept {
+#ifdef BINARY_SEARCH_TREE_HAS_MMAP
+    if (region.data != nullptr) {
+        ::munmap(region.data, region.size);
+    }
+#else
+    (void)region;
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+// How the pages of a mapping are backed.
+enum class PageBacking {
+    // Regular 4 KiB pages: huge pages were unavailable or refused.
+    Small,
+    // Transparent huge pages requested with madvise(MADV_HUGEPAGE); the kernel may still use small pages.
+    Transparent,
+    // Pages reserved in the hugetlb pool with MAP_HUGETLB.
+    Explicit,
+};
+
+constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+// Anonymous read-write mapping rounded up to whole 2 MiB pages and aligned to 2 MiB.
+struct PageRegion {
+    void* data = nullptr;
+    std::size_t size = 0;
+    PageBacking backing = PageBacking::Small;
+};
+
+// Tries MAP_HUGETLB first, then a 2 MiB-aligned mapping advised with MADV_HUGEPAGE. Returns an empty
+// region if nothing could be mapped or the platform has no mmap.
+PageRegion map_huge_pages(std::size_t bytes) noexcept;
+void unmap_pages(const PageRegion& region) noexcept;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+
+struct InstrumentationStats {
+    unsigned long long comparisons = 0;
+    unsigned long long descents = 0;
+    unsigned long long node_visits = 0;
+    unsigned long long allocations = 0;
+    unsigned long long deallocations = 0;
+    unsigned long long rotations = 0;
+    unsigned long long iterator_steps = 0;
+
+    double visits_per_descent() const {
+        return descents == 0 ? 0.0 : static_cast<double>(node_visits) / static_cast<double>(descents);
+    }
+};
+
+// Default policy: every hook is an empty inline function and the policy and its iterator handle are empty
+// types, so an uninstrumented tree and its iterators are laid out and compiled exactly as without hooks.
+struct NoInstrumentation {
+    struct handle_type {
+        void on_iterator_step() const noexcept {}
+    };
+
+    handle_type handle() const noexcept { return {}; }
+
+    void on_compare() const noexcept {}
+    void on_descent() const noexcept {}
+    void on_visit() const noexcept {}
+    void on_allocate(unsigned long long = 1) const noexcept {}
+    void on_deallocate(unsigned long long = 1) const noexcept {}
+    void on_rotate() const noexcept {}
+
+    InstrumentationStats stats() const noexcept { return {}; }
+    void reset() noexcept {}
+};
+
+// Counters are relaxed atomics so that concurrent readers and insert_batch workers are counted too.
+// Comparisons made while sorting an insert_batch or rebuilding a loaded tree are not counted.
+class CountingInstrumentation {
+public:
+    class handle_type {
+    public:
+        handle_type() = default;
+        explicit handle_type(const CountingInstrumentation* owner) : owner_(owner) {}
+
+        void on_iterator_step() const noexcept {
+            if (owner_ != nullptr) {
+                owner_->iterator_steps_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        const CountingInstrumentation* owner_ = nullptr;
+    };
+
+    handle_type handle() const noexcept { return handle_type(this); }
+
+    void on_compare() const noexcept { comparisons_.fetch_add(1, std::memory_order_relaxed); }
+    void on_descent() const noexcept { descents_.fetch_add(1, std::memory_order_relaxed); }
+    void on_visit() const noexcept { node_visits_.fetch_add(1, std::memory_order_relaxed); }
+    void on_allocate(unsigned long long n = 1) const noexcept { allocations_.fetch_add(n, std::memory_order_relaxed); }
+    void on_deallocate(unsigned long long n = 1) const noexcept { deallocations_.fetch_add(n, std::memory_order_relaxed); }
+    void on_rotate() const noexcept { rotations_.fetch_add(1, std::memory_order_relaxed); }
+
+    InstrumentationStats stats() const noexcept {
+        InstrumentationStats stats;
+        stats.comparisons = comparisons_.load(std::memory_order_relaxed);
+        stats.descents = descents_.load(std::memory_order_relaxed);
+        stats.node_visits = node_visits_.load(std::memory_order_relaxed);
+        stats.allocations = allocations_.load(std::memory_order_relaxed);
+        stats.deallocations = deallocations_.load(std::memory_order_relaxed);
+        stats.rotations = rotations_.load(std::memory_order_relaxed);
+        stats.iterator_steps = iterator_steps_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void reset() noexcept {
+        comparisons_ = 0;
+        descents_ = 0;
+        node_visits_ = 0;
+        allocations_ = 0;
+        deallocations_ = 0;
+        rotations_ = 0;
+        iterator_steps_ = 0;
+    }
+
+private:
+    mutable std::atomic<unsigned long long> comparisons_ = 0;
+    mutable std::atomic<unsigned long long> descents_ = 0;
+    mutable std::atomic<unsigned long long> node_visits_ = 0;
+    mutable std::atomic<unsigned long long> allocations_ = 0;
+    mutable std::atomic<unsigned long long> deallocations_ = 0;
+    mutable std::atomic<unsigned long long> rotations_ = 0;
+    mutable std::atomic<unsigned long long> iterator_steps_ = 0;
+};
@@ -1,10 +1,11 @@
 #pragma once
 
+#include "Instrumentation.h"
 #include "Node.h"
 #include "tag.cpp"
 #include "ReverseIterator.h"
 
-template<class T, class Traversal = InOrder, class Category = std::bidirectional_iterator_tag, class Distance = std::ptrdiff_t, class Pointer = const T*, class Reference = const T&>
+template<class T, class Traversal = InOrder, class Category = std::bidirectional_iterator_tag, class Distance = std::ptrdiff_t, class Pointer = const T*, class Reference = const T&, class Instrumentation = NoInstrumentation>
 class const_iterator_ {
 public:
     typedef InOrder traversal_type;
@@ -14,9 +15,10 @@ public:
     typedef const T* pointer;
     typedef const T& reference;
     typedef Node<T> node_type;
+    typedef typename Instrumentation::handle_type instrumentation_handle;
 
     const_iterator_();
-    explicit const_iterator_(node_type* node);
+    explicit const_iterator_(node_type* node, instrumentation_handle instrumentation = instrumentation_handle());
     const_iterator_(const const_iterator_& iter);
     ~const_iterator_();
 
@@ -40,6 +42,7 @@ public:
     node_type* get_node() const;
 private:
     node_type* node;
+    [[no_unique_address]] instrumentation_handle instrumentation_;
 
     const_iterator_& pre_increment(tag<InOrder>);
     const_iterator_ post_increment(tag<InOrder>);
@@ -57,83 +60,88 @@ private:
     const_iterator_ post_decrement(tag<PostOrder>);
 };
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_iterator_() {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_iterator_() {
     node = nullptr;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_iterator_(const_iterator_::node_type* node) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_iterator_(const_iterator_::node_type* node, instrumentation_handle instrumentation) : instrumentation_(instrumentation) {
     this->node = node;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_iterator_(const const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& iter) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_iterator_(const const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& iter) : instrumentation_(iter.instrumentation_) {
     node = iter.get_node();
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::~const_iterator_() {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::~const_iterator_() {
     node = nullptr;
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator=(const const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& iter) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator=(const const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& iter) {
     node = iter.get_node();
+    instrumentation_ = iter.instrumentation_;
     return *this;
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-bool const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator==(const const_iterator_& iter) const {
-    if (node->is_end_ && iter.get_node()->is_end_ && node->parent_ == iter.get_node()->parent_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+bool const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator==(const const_iterator_& iter) const {
+    if (node->is_end() && iter.get_node()->is_end() && node->parent_ == iter.get_node()->parent_) {
         return true;
     }
-    if (node->is_end_ && iter.get_node()->is_end_) {
+    if (node->is_end() && iter.get_node()->is_end()) {
         return false;
     }
     return node != iter.get_node();
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-bool const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator!=(const const_iterator_& iter) const {
-    if (node->is_end_ && iter.get_node()->is_end_ && node->parent_ == iter.get_node()->parent_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+bool const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator!=(const const_iterator_& iter) const {
+    if (node->is_end() && iter.get_node()->is_end() && node->parent_ == iter.get_node()->parent_) {
         return false;
     }
-    if (node->is_end_ && iter.get_node()->is_end_) {
+    if (node->is_end() && iter.get_node()->is_end()) {
         return true;
     }
     return node != iter.get_node();
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator++() {
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator++() {
+    instrumentation_.on_iterator_step();
     return pre_increment(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator++(int) {
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator++(int) {
+    instrumentation_.on_iterator_step();
     return post_increment(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator--() {
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator--() {
+    instrumentation_.on_iterator_step();
     return pre_decrement(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator--(int) {
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator--(int) {
+    instrumentation_.on_iterator_step();
     return post_decrement(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<InOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<InOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -147,10 +155,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<InOrder>) {
-    const_iterator_<T, InOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<InOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -164,9 +172,9 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<InOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<InOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -180,10 +188,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<InOrder>) {
-    const_iterator_<T, InOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<InOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -198,9 +206,9 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<PreOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<PreOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -225,10 +233,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<PreOrder>) {
-    const_iterator_<T, PreOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<PreOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -253,9 +261,9 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<PreOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<PreOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -273,10 +281,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<PreOrder>) {
-    const_iterator_<T, PreOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<PreOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -296,9 +304,9 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
 
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<PostOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<PostOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -316,10 +324,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<PostOrder>) {
-    const_iterator_<T, PostOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<PostOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -337,9 +345,9 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<PostOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<PostOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -364,10 +372,10 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_ite
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<PostOrder>) {
-    const_iterator_<T, PostOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<PostOrder>) {
+    const_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -392,17 +400,17 @@ const_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_iter
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::reference const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator*() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::reference const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator*() const {
     return node->data_;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pointer const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator->() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pointer const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator->() const {
     return (*this);
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::node_type* const_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::get_node() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::node_type* const_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::get_node() const {
     return node;
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// Position of a key among the `count` sorted keys of a node: lower_index is the number of keys that
+// compare less than `key`, upper_index the number that do not compare greater.
+template<class Key, class Compare>
+struct key_search {
+    static unsigned lower_index(const Key* keys, unsigned count, const Key& key) {
+        return std::lower_bound(keys, keys + count, key, Compare()) - keys;
+    }
+
+    static unsigned upper_index(const Key* keys, unsigned count, const Key& key) {
+        return std::upper_bound(keys, keys + count, key, Compare()) - keys;
+    }
+};
+
+template<class Key>
+concept simd_searchable_key = std::is_same_v<Key, float> || (std::is_integral_v<Key> && std::is_signed_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8));
+
+// With std::less on 32/64-bit signed integers and floats the keys are compared against the probe all at
+// once and the matches counted, so a node costs a few vector instructions and no data-dependent branch.
+// The widest instruction set enabled at compile time is used: AVX2, then SSE4.2 (SSE2 for 32-bit keys),
+// then a branch-free scalar loop that the compiler can vectorise on its own.
+namespace key_search_detail {
+
+template<class Key>
+unsigned count_less_scalar(const Key* keys, unsigned first, unsigned count, Key key) {
+    unsigned result = 0;
+    for (unsigned i = first; i < count; ++i) {
+        result += keys[i] < key;
+    }
+    return result;
+}
+
+template<class Key>
+unsigned count_greater_scalar(const Key* keys, unsigned first, unsigned count, Key key) {
+    unsigned result = 0;
+    for (unsigned i = first; i < count; ++i) {
+        result += key < keys[i];
+    }
+    return result;
+}
+
+#if defined(__AVX2__)
+
+inline unsigned mask_count(__m256i mask) {
+    return std::popcount(static_cast<unsigned>(_mm256_movemask_epi8(mask))) / 4;
+}
+
+inline unsigned mask_count64(__m256i mask) {
+    return std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(mask))));
+}
+
+template<class Key>
+unsigned count_less(const Key* keys, unsigned count, Key key) {
+    unsigned result = 0;
+    unsigned i = 0;
+    if constexpr (std::is_same_v<Key, float>) {
+        __m256 probe = _mm256_set1_ps(key);
+        for (; i + 8 <= count; i += 8) {
+            __m256 less = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), probe, _CMP_LT_OQ);
+            result += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(less)));
+        }
+    } else if constexpr (sizeof(Key) == 4) {
+        __m256i probe = _mm256_set1_epi32(key);
+        for (; i + 8 <= count; i += 8) {
+            result += mask_count(_mm256_cmpgt_epi32(probe, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i))));
+        }
+    } else {
+        __m256i probe = _mm256_set1_epi64x(key);
+        for (; i + 4 <= count; i += 4) {
+            result += mask_count64(_mm256_cmpgt_epi64(probe, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i))));
+        }
+    }
+    return result + count_less_scalar(keys, i, count, key);
+}
+
+template<class Key>
+unsigned count_greater(const Key* keys, unsigned count, Key key) {
+    unsigned result = 0;
+    unsigned i = 0;
+    if constexpr (std::is_same_v<Key, float>) {
+        __m256 probe = _mm256_set1_ps(key);
+        for (; i + 8 <= count; i += 8) {
+            __m256 greater = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), probe, _CMP_GT_OQ);
+            result += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(greater)));
+        }
+    } else if constexpr (sizeof(Key) == 4) {
+        __m256i probe = _mm256_set1_epi32(key);
+        for (; i + 8 <= count; i += 8) {
+            result += mask_count(_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), probe));
+        }
+    } else {
+        __m256i probe = _mm256_set1_epi64x(key);
+        for (; i + 4 <= count; i += 4) {
+            result += mask_count64(_mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), probe));
+        }
+    }
+    return result + count_greater_scalar(keys, i, count, key);
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+template<class Key>
+unsigned count_less(const Key* keys, unsigned count, Key key) {
+    unsigned result = 0;
+    unsigned i = 0;
+    if constexpr (std::is_same_v<Key, float>) {
+        __m128 probe = _mm_set1_ps(key);
+        for (; i + 4 <= count; i += 4) {
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(keys + i), probe))));
+        }
+    } else if constexpr (sizeof(Key) == 4) {
+        __m128i probe = _mm_set1_epi32(key);
+        for (; i + 4 <= count; i += 4) {
+            __m128i less = _mm_cmpgt_epi32(probe, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(less))));
+        }
+    }
+#if defined(__SSE4_2__)
+    else {
+        __m128i probe = _mm_set1_epi64x(key);
+        for (; i + 2 <= count; i += 2) {
+            __m128i less = _mm_cmpgt_epi64(probe, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(less))));
+        }
+    }
+#endif
+    return result + count_less_scalar(keys, i, count, key);
+}
+
+template<class Key>
+unsigned count_greater(const Key* keys, unsigned count, Key key) {
+    unsigned result = 0;
+    unsigned i = 0;
+    if constexpr (std::is_same_v<Key, float>) {
+        __m128 probe = _mm_set1_ps(key);
+        for (; i + 4 <= count; i += 4) {
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(keys + i), probe))));
+        }
+    } else if constexpr (sizeof(Key) == 4) {
+        __m128i probe = _mm_set1_epi32(key);
+        for (; i + 4 <= count; i += 4) {
+            __m128i greater = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), probe);
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(greater))));
+        }
+    }
+#if defined(__SSE4_2__)
+    else {
+        __m128i probe = _mm_set1_epi64x(key);
+        for (; i + 2 <= count; i += 2) {
+            __m128i greater = _mm_cmpgt_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), probe);
+            result += std::popcount(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(greater))));
+        }
+    }
+#endif
+    return result + count_greater_scalar(keys, i, count, key);
+}
+
+#else
+
+template<class Key>
+unsigned count_less(const Key* keys, unsigned count, Key key) {
+    return count_less_scalar(keys, 0, count, key);
+}
+
+template<class Key>
+unsigned count_greater(const Key* keys, unsigned count, Key key) {
+    return count_greater_scalar(keys, 0, count, key);
+}
+
+#endif
+
+}
+
+template<simd_searchable_key Key>
+struct key_search<Key, std::less<Key>> {
+    static unsigned lower_index(const Key* keys, unsigned count, const Key& key) {
+        return key_search_detail::count_less(keys, count, key);
+    }
+
+    static unsigned upper_index(const Key* keys, unsigned count, const Key& key) {
+        return count - key_search_detail::count_greater(keys, count, key);
+    }
+};
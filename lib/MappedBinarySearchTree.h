@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "MappedFile.h"
+
+// Layout of a mapped tree: MappedTreeHeader, padding up to nodes_offset, then `count` MappedNode records
+// stored in key order. Children are addressed by their distance in records from the parent (0 means no
+// child), so the image has no pointers and is usable wherever it is mapped. Integers use host byte order.
+struct MappedTreeHeader {
+    static constexpr char kMagic[4] = {'B', 'S', 'T', 'M'};
+    static constexpr std::uint16_t kVersion = 1;
+
+    char magic[4] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3]};
+    std::uint16_t version = kVersion;
+    std::uint16_t key_size = 0;
+    std::uint32_t node_size = 0;
+    std::uint64_t count = 0;
+    std::uint64_t root = 0;
+    std::uint64_t nodes_offset = 0;
+};
+
+template<typename T>
+struct MappedNode {
+    T data_;
+    std::int32_t left_;
+    std::int32_t right_;
+};
+
+// Read-only view of an image written by BinarySearchTree::save_mapped. Opening checks only the header;
+// nodes are used in place, so lookups touch just the pages on their root-to-leaf path. Child offsets are
+// checked as they are followed, so a corrupt image gives wrong answers but never reads past the nodes.
+template<class Key, class Compare = std::less<Key>>
+class MappedBinarySearchTree {
+public:
+    static_assert(std::is_trivially_copyable_v<Key>, "mapped trees store keys by value");
+
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef const value_type& const_reference;
+    typedef MappedNode<Key> node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    MappedBinarySearchTree() = default;
+    explicit MappedBinarySearchTree(const char* path);
+    explicit MappedBinarySearchTree(std::span<const std::byte> image);
+
+    [[nodiscard]] bool is_open() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+
+private:
+    MappedFile file_;
+    const node_type* nodes_ = nullptr;
+    const node_type* root_ = nullptr;
+    size_type size_ = 0;
+
+    bool attach(std::span<const std::byte> image);
+
+    const node_type* child(const node_type* node, std::int32_t offset, size_type low, size_type high) const;
+};
+
+// Records are stored in key order, so iteration is a linear scan of the mapping.
+template<class Key, class Compare>
+class MappedBinarySearchTree<Key, Compare>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    explicit const_iterator(const node_type* node) : node_(node) {}
+
+    reference operator*() const { return node_->data_; }
+    pointer operator->() const { return &node_->data_; }
+
+    const_iterator& operator++() {
+        ++node_;
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++node_;
+        return temp;
+    }
+    const_iterator& operator--() {
+        --node_;
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --node_;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+    bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    const node_type* get_node() const { return node_; }
+
+private:
+    const node_type* node_ = nullptr;
+};
+
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::MappedBinarySearchTree(const char* path) : file_(path) {
+    if (!attach(file_.bytes())) {
+        file_ = MappedFile();
+        return;
+    }
+    file_.advise_random();
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::MappedBinarySearchTree(std::span<const std::byte> image) {
+    attach(image);
+}
+
+template<class Key, class Compare>
+bool MappedBinarySearchTree<Key, Compare>::attach(std::span<const std::byte> image) {
+    MappedTreeHeader header;
+    if (image.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, image.data(), sizeof(header));
+    if (std::memcmp(header.magic, MappedTreeHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != MappedTreeHeader::kVersion || header.key_size != sizeof(Key) ||
+        header.node_size != sizeof(node_type) || header.nodes_offset < sizeof(header) ||
+        header.nodes_offset > image.size() ||
+        header.count > (image.size() - header.nodes_offset) / sizeof(node_type) ||
+        (header.count != 0 && header.root >= header.count)) {
+        return false;
+    }
+    const std::byte* nodes = image.data() + header.nodes_offset;
+    if (reinterpret_cast<std::uintptr_t>(nodes) % alignof(node_type) != 0) {
+        return false;
+    }
+    nodes_ = reinterpret_cast<const node_type*>(nodes);
+    root_ = header.count == 0 ? nullptr : nodes_ + header.root;
+    size_ = header.count;
+    return true;
+}
+
+template<class Key, class Compare>
+bool MappedBinarySearchTree<Key, Compare>::is_open() const noexcept {
+    return nodes_ != nullptr;
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::const_iterator MappedBinarySearchTree<Key, Compare>::begin() const noexcept {
+    return const_iterator(nodes_);
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::const_iterator MappedBinarySearchTree<Key, Compare>::end() const noexcept {
+    return const_iterator(nodes_ + size_);
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare>
+bool MappedBinarySearchTree<Key, Compare>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::size_type MappedBinarySearchTree<Key, Compare>::size() const noexcept {
+    return size_;
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::size_type MappedBinarySearchTree<Key, Compare>::count(const Key& key) const {
+    return upper_bound(key).get_node() - lower_bound(key).get_node();
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::const_iterator MappedBinarySearchTree<Key, Compare>::find(const Key& key) const {
+    const_iterator it = lower_bound(key);
+    if (it != end() && !Compare()(key, *it)) {
+        return it;
+    }
+    return end();
+}
+
+template<class Key, class Compare>
+bool MappedBinarySearchTree<Key, Compare>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<class Key, class Compare>
+std::pair<typename MappedBinarySearchTree<Key, Compare>::const_iterator, typename MappedBinarySearchTree<Key, Compare>::const_iterator> MappedBinarySearchTree<Key, Compare>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::const_iterator MappedBinarySearchTree<Key, Compare>::lower_bound(const Key& key) const {
+    const node_type* result = nodes_ + size_;
+    size_type low = 0;
+    size_type high = size_;
+    for (const node_type* node = root_; node != nullptr;) {
+        if (Compare()(node->data_, key)) {
+            low = node - nodes_ + 1;
+            node = child(node, node->right_, low, high);
+        } else {
+            result = node;
+            high = node - nodes_;
+            node = child(node, node->left_, low, high);
+        }
+    }
+    return const_iterator(result);
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::const_iterator MappedBinarySearchTree<Key, Compare>::upper_bound(const Key& key) const {
+    const node_type* result = nodes_ + size_;
+    size_type low = 0;
+    size_type high = size_;
+    for (const node_type* node = root_; node != nullptr;) {
+        if (Compare()(key, node->data_)) {
+            result = node;
+            high = node - nodes_;
+            node = child(node, node->left_, low, high);
+        } else {
+            low = node - nodes_ + 1;
+            node = child(node, node->right_, low, high);
+        }
+    }
+    return const_iterator(result);
+}
+
+template<class Key, class Compare>
+MappedBinarySearchTree<Key, Compare>::key_compare MappedBinarySearchTree<Key, Compare>::key_comp() const {
+    return Compare();
+}
+
+// Records are in key order, so a child must lie in [low, high), the index range of the subtree the descent
+// has narrowed to. Anything else ends the descent; the range shrinks on every step, so it cannot loop.
+template<class Key, class Compare>
+const MappedBinarySearchTree<Key, Compare>::node_type* MappedBinarySearchTree<Key, Compare>::child(const node_type* node, std::int32_t offset, size_type low, size_type high) const {
+    std::int64_t index = (node - nodes_) + static_cast<std::int64_t>(offset);
+    if (offset == 0 || index < static_cast<std::int64_t>(low) || index >= static_cast<std::int64_t>(high)) {
+        return nullptr;
+    }
+    return nodes_ + index;
+}
@@ -0,0 +1,72 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BINARY_SEARCH_TREE_HAS_MMAP 1
+#endif
+
+MappedFile::MappedFile(const char* path) {
+#ifdef BINARY_SEARCH_TREE_HAS_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            data_ = data;
+            size_ = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+bool MappedFile::is_open() const noexcept {
+    return data_ != nullptr;
+}
+
+std::span<const std::byte> MappedFile::bytes() const noexcept {
+    return {static_cast<const std::byte*>(data_), size_};
+}
+
+void MappedFile::advise_random() const noexcept {
+#ifdef BINARY_SEARCH_TREE_HAS_MMAP
+    if (data_ != nullptr) {
+        ::madvise(data_, size_, MADV_RANDOM);
+    }
+#endif
+}
+
+void MappedFile::close() noexcept {
+#ifdef BINARY_SEARCH_TREE_HAS_MMAP
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
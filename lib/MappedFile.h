@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// Read-only private mapping of a whole file. Pages are faulted in lazily on first access.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const char* path);
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept;
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept;
+
+    void advise_random() const noexcept;
+
+private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    void close() noexcept;
+};
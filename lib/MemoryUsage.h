@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Memory a tree holds, split by what it is spent on. Overheads are estimates for a typical 64-bit
+// malloc, see heap_overhead().
+struct MemoryUsage {
+    unsigned long long nodes = 0;
+    // nodes * sizeof(node), keys included.
+    unsigned long long node_bytes = 0;
+    // Heap payload owned by the keys themselves, as reported by key_heap_usage.
+    unsigned long long key_heap_bytes = 0;
+    // Free slots kept by reserve() and not yet used.
+    unsigned long long reserved_bytes = 0;
+    // Allocator headers and rounding of every allocation, plus the pool's block bookkeeping.
+    unsigned long long overhead_bytes = 0;
+
+    unsigned long long total_bytes() const {
+        return node_bytes + key_heap_bytes + reserved_bytes + overhead_bytes;
+    }
+};
+
+// Bytes malloc adds to a request of `bytes`: an 8-byte chunk header, 16-byte granularity and a 32-byte
+// minimum chunk, as in glibc on 64-bit targets.
+constexpr std::size_t heap_overhead(std::size_t bytes) {
+    std::size_t chunk = (bytes + 8 + 15) & ~std::size_t(15);
+    return (chunk < 32 ? 32 : chunk) - bytes;
+}
+
+// Heap bytes a key owns outside its own object. Specialize it for key types with heap payloads; the
+// result must not change while the key is in the tree.
+template<class Key>
+struct key_heap_usage {
+    static std::size_t bytes(const Key&) {
+        return 0;
+    }
+};
+
+// Strings short enough for the inline buffer own no heap memory.
+template<class CharT, class Traits, class StringAllocator>
+struct key_heap_usage<std::basic_string<CharT, Traits, StringAllocator>> {
+    typedef std::basic_string<CharT, Traits, StringAllocator> string_type;
+
+    static std::size_t bytes(const string_type& key) {
+        std::less<const void*> less;
+        const void* data = key.data();
+        if (!less(data, &key) && less(data, &key + 1)) {
+            return 0;
+        }
+        return (key.capacity() + 1) * sizeof(CharT);
+    }
+};
@@ -0,0 +1,500 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "NodeAlgorithms.h"
+
+// Node standing for count_ equal keys.
+template<typename K>
+struct MultiplicityNode {
+    MultiplicityNode(const K& key, unsigned long long count, MultiplicityNode<K>* parent) : key_(key), count_(count), parent_(parent) {}
+
+    K key_;
+    unsigned long long count_;
+    MultiplicityNode<K>* left_ = nullptr;
+    MultiplicityNode<K>* right_ = nullptr;
+    MultiplicityNode<K>* parent_ = nullptr;
+};
+
+// Unbalanced binary search tree with multiset semantics that keeps one node per distinct key and counts
+// its copies, so count() and erase(key) cost one descent however many copies there are, and inserting
+// a duplicate allocates nothing. Iteration still yields every copy: an iterator is a node and the index
+// of a copy in it. Copies of a key are interchangeable, so erase(pos) removes one of them and iterators
+// to later copies of the same key then point one copy further on.
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class MultiplicityBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Allocator allocator_type;
+    typedef const value_type& reference;
+    typedef const value_type& const_reference;
+    typedef MultiplicityNode<Key> node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    MultiplicityBinarySearchTree() = default;
+    explicit MultiplicityBinarySearchTree(const Allocator& alloc);
+    template<class InputIt>
+    MultiplicityBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    MultiplicityBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+    MultiplicityBinarySearchTree(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& other);
+    MultiplicityBinarySearchTree(MultiplicityBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+    ~MultiplicityBinarySearchTree();
+
+    MultiplicityBinarySearchTree<Key, Compare, Allocator>& operator=(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& other);
+    MultiplicityBinarySearchTree<Key, Compare, Allocator>& operator=(MultiplicityBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    // Copies, as in a multiset.
+    [[nodiscard]] size_type size() const noexcept;
+    // Distinct keys, one node each.
+    [[nodiscard]] size_type distinct_size() const noexcept;
+    [[nodiscard]] size_type max_size() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    // Returns the first copy of the key.
+    iterator insert(const value_type& value);
+    iterator insert_copies(const value_type& value, size_type copies);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const key_type& key);
+    void swap(MultiplicityBinarySearchTree<Key, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const key_type& key) const;
+    const_iterator find(const key_type& key) const;
+    bool contains(const key_type& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const;
+    const_iterator lower_bound(const key_type& key) const;
+    const_iterator upper_bound(const key_type& key) const;
+
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+    bool operator==(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& rhs) const;
+    bool operator!=(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<node_type> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    typedef NodeAlgorithms<PointerLinks<node_type>> algorithms;
+
+    node_type* root_ = nullptr;
+    size_type size_ = 0;
+    size_type distinct_size_ = 0;
+    [[no_unique_address]] node_allocator node_allocator_;
+
+    node_type* find_node(const key_type& key) const;
+    // Takes `copies` copies off the node and unlinks it when none are left.
+    void remove_copies(node_type* node, size_type copies);
+    node_type* make_node(const key_type& key, size_type count, node_type* parent);
+    void destroy_node(node_type* node);
+};
+
+template<class Key, class Compare, class Allocator>
+class MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const MultiplicityBinarySearchTree<Key, Compare, Allocator>* tree, node_type* node, size_type index = 0) : tree_(tree), node_(node), index_(index) {}
+
+    reference operator*() const { return node_->key_; }
+    pointer operator->() const { return &node_->key_; }
+    // Copies of the key at this position, including the ones before it.
+    size_type multiplicity() const { return node_->count_; }
+
+    const_iterator& operator++() {
+        if (++index_ == node_->count_) {
+            node_ = algorithms::successor({}, node_);
+            index_ = 0;
+        }
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        if (index_ > 0) {
+            --index_;
+            return *this;
+        }
+        node_ = node_ == nullptr ? algorithms::maximum({}, tree_->root_) : algorithms::predecessor({}, node_);
+        index_ = node_->count_ - 1;
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return node_ == other.node_ && index_ == other.index_; }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    node_type* get_node() const { return node_; }
+    size_type get_index() const { return index_; }
+
+private:
+    const MultiplicityBinarySearchTree<Key, Compare, Allocator>* tree_ = nullptr;
+    node_type* node_ = nullptr;
+    size_type index_ = 0;
+};
+
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::MultiplicityBinarySearchTree(const Allocator& alloc) : node_allocator_(alloc) {}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::MultiplicityBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : MultiplicityBinarySearchTree<Key, Compare, Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::MultiplicityBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : MultiplicityBinarySearchTree<Key, Compare, Allocator>(init.begin(), init.end(), alloc) {}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::MultiplicityBinarySearchTree(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& other)
+        : node_allocator_(node_traits::select_on_container_copy_construction(other.node_allocator_)) {
+    root_ = algorithms::copy({}, other.root_, [this](node_type* source, node_type* parent) {
+        return make_node(source->key_, source->count_, parent);
+    });
+    size_ = other.size_;
+    distinct_size_ = other.distinct_size_;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::MultiplicityBinarySearchTree(MultiplicityBinarySearchTree<Key, Compare, Allocator>&& other) noexcept : node_allocator_(other.node_allocator_) {
+    swap(other);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::~MultiplicityBinarySearchTree() {
+    clear();
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>& MultiplicityBinarySearchTree<Key, Compare, Allocator>::operator=(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& other) {
+    if (this != &other) {
+        MultiplicityBinarySearchTree<Key, Compare, Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>& MultiplicityBinarySearchTree<Key, Compare, Allocator>::operator=(MultiplicityBinarySearchTree<Key, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::allocator_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::get_allocator() const noexcept {
+    return allocator_type(node_allocator_);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::begin() const noexcept {
+    return const_iterator(this, algorithms::minimum({}, root_));
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::end() const noexcept {
+    return const_iterator(this, nullptr);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::cbegin() const noexcept {
+    return begin();
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::cend() const noexcept {
+    return end();
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare, class Allocator>
+bool MultiplicityBinarySearchTree<Key, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::size_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::size_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::distinct_size() const noexcept {
+    return distinct_size_;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::size_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::max_size() const noexcept {
+    return node_traits::max_size(node_allocator_);
+}
+
+
+// Implementation of modifiers
+
+template<class Key, class Compare, class Allocator>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::clear() noexcept {
+    algorithms::destroy({}, root_, [this](node_type* node) {
+        destroy_node(node);
+    });
+    root_ = nullptr;
+    size_ = 0;
+    distinct_size_ = 0;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::insert(const value_type& value) {
+    return insert_copies(value, 1);
+}
+
+// A key already present only has its count raised.
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::insert_copies(const value_type& value, size_type copies) {
+    if (copies == 0) {
+        return find(value);
+    }
+    node_type* parent = nullptr;
+    node_type** slot = &root_;
+    while (*slot != nullptr) {
+        parent = *slot;
+        bool right = Compare()(parent->key_, value);
+        bool left = Compare()(value, parent->key_);
+        if (!(right | left)) {
+            parent->count_ += copies;
+            size_ += copies;
+            return iterator(this, parent);
+        }
+        slot = right ? &parent->right_ : &parent->left_;
+    }
+    *slot = make_node(value, copies, parent);
+    size_ += copies;
+    ++distinct_size_;
+    return iterator(this, *slot);
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::erase(const_iterator pos) {
+    node_type* node = pos.get_node();
+    size_type index = pos.get_index();
+    if (index + 1 < node->count_) {
+        remove_copies(node, 1);
+        return iterator(this, node, index);
+    }
+    node_type* next = algorithms::successor({}, node);
+    remove_copies(node, 1);
+    return iterator(this, next);
+}
+
+// Whole nodes between the ends go at once; the node of last keeps its copies from last on.
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::erase(const_iterator first, const_iterator last) {
+    node_type* node = first.get_node();
+    size_type index = first.get_index();
+    while (node != last.get_node()) {
+        node_type* next = algorithms::successor({}, node);
+        remove_copies(node, node->count_ - index);
+        node = next;
+        index = 0;
+    }
+    if (node != nullptr && last.get_index() > index) {
+        remove_copies(node, last.get_index() - index);
+    }
+    return iterator(this, node, index);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::size_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::erase(const key_type& key) {
+    node_type* node = find_node(key);
+    if (node == nullptr) {
+        return 0;
+    }
+    size_type count = node->count_;
+    remove_copies(node, count);
+    return count;
+}
+
+template<class Key, class Compare, class Allocator>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::swap(MultiplicityBinarySearchTree<Key, Compare, Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(distinct_size_, other.distinct_size_);
+    std::swap(node_allocator_, other.node_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::size_type MultiplicityBinarySearchTree<Key, Compare, Allocator>::count(const key_type& key) const {
+    node_type* node = find_node(key);
+    return node == nullptr ? 0 : node->count_;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::find(const key_type& key) const {
+    return const_iterator(this, find_node(key));
+}
+
+template<class Key, class Compare, class Allocator>
+bool MultiplicityBinarySearchTree<Key, Compare, Allocator>::contains(const key_type& key) const {
+    return find_node(key) != nullptr;
+}
+
+template<class Key, class Compare, class Allocator>
+std::pair<typename MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator, typename MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator> MultiplicityBinarySearchTree<Key, Compare, Allocator>::equal_range(const key_type& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::lower_bound(const key_type& key) const {
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool right = Compare()(node->key_, key);
+        result = right ? result : node;
+        node = right ? node->right_ : node->left_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::const_iterator MultiplicityBinarySearchTree<Key, Compare, Allocator>::upper_bound(const key_type& key) const {
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool left = Compare()(key, node->key_);
+        result = left ? node : result;
+        node = left ? node->left_ : node->right_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::key_compare MultiplicityBinarySearchTree<Key, Compare, Allocator>::key_comp() const {
+    return Compare();
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::value_compare MultiplicityBinarySearchTree<Key, Compare, Allocator>::value_comp() const {
+    return Compare();
+}
+
+// Compares node by node: equal keys with equal counts.
+template<class Key, class Compare, class Allocator>
+bool MultiplicityBinarySearchTree<Key, Compare, Allocator>::operator==(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& rhs) const {
+    if (size_ != rhs.size_ || distinct_size_ != rhs.distinct_size_) {
+        return false;
+    }
+    node_type* rhs_node = algorithms::minimum({}, rhs.root_);
+    for (node_type* node = algorithms::minimum({}, root_); node != nullptr; node = algorithms::successor({}, node)) {
+        if (node->count_ != rhs_node->count_ || !(node->key_ == rhs_node->key_)) {
+            return false;
+        }
+        rhs_node = algorithms::successor({}, rhs_node);
+    }
+    return true;
+}
+
+template<class Key, class Compare, class Allocator>
+bool MultiplicityBinarySearchTree<Key, Compare, Allocator>::operator!=(const MultiplicityBinarySearchTree<Key, Compare, Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+// Compares both ways before branching, so only the exit on an equal key is a real branch.
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::node_type* MultiplicityBinarySearchTree<Key, Compare, Allocator>::find_node(const key_type& key) const {
+    node_type* node = root_;
+    while (node != nullptr) {
+        bool right = Compare()(node->key_, key);
+        bool left = Compare()(key, node->key_);
+        if (!(right | left)) {
+            break;
+        }
+        node = right ? node->right_ : node->left_;
+    }
+    return node;
+}
+
+template<class Key, class Compare, class Allocator>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::remove_copies(node_type* node, size_type copies) {
+    node->count_ -= copies;
+    size_ -= copies;
+    if (node->count_ != 0) {
+        return;
+    }
+    algorithms::unlink({}, root_, node);
+    destroy_node(node);
+    --distinct_size_;
+}
+
+template<class Key, class Compare, class Allocator>
+MultiplicityBinarySearchTree<Key, Compare, Allocator>::node_type* MultiplicityBinarySearchTree<Key, Compare, Allocator>::make_node(const key_type& key, size_type count, node_type* parent) {
+    node_type* node = node_traits::allocate(node_allocator_, 1);
+    node_traits::construct(node_allocator_, node, key, count, parent);
+    return node;
+}
+
+template<class Key, class Compare, class Allocator>
+void MultiplicityBinarySearchTree<Key, Compare, Allocator>::destroy_node(node_type* node) {
+    node_traits::destroy(node_allocator_, node);
+    node_traits::deallocate(node_allocator_, node, 1);
+}
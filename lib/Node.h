@@ -1,7 +1,44 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Link that keeps per-node flags in the low bits every node address leaves zero. Reads and writes go
+// through the pointer, which leaves the flags alone, so it can stand in for a plain parent pointer.
+template<typename NodeT>
+class TaggedPointer {
+public:
+    static constexpr std::uintptr_t kFlagBits = 2;
+    static constexpr std::uintptr_t kFlagMask = (std::uintptr_t(1) << kFlagBits) - 1;
+
+    TaggedPointer() = default;
+    TaggedPointer(NodeT* pointer) : bits_(reinterpret_cast<std::uintptr_t>(pointer)) {}
+
+    TaggedPointer& operator=(NodeT* pointer) {
+        bits_ = reinterpret_cast<std::uintptr_t>(pointer) | (bits_ & kFlagMask);
+        return *this;
+    }
+
+    NodeT* get() const { return reinterpret_cast<NodeT*>(bits_ & ~kFlagMask); }
+    operator NodeT*() const { return get(); }
+    NodeT* operator->() const { return get(); }
+
+    bool test(std::uintptr_t flag) const { return (bits_ & flag) != 0; }
+    void set(std::uintptr_t flag, bool value) { bits_ = value ? bits_ | flag : bits_ & ~flag; }
+
+private:
+    std::uintptr_t bits_ = 0;
+};
+
+// Key first, then the links, so for keys of up to 40 bytes the key and all three links share one
+// cache line. Flags live in the parent link: kEndFlag marks the end() sentinel and kSpareFlag is
+// free for balancing or threading metadata.
 template<typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
 struct Node {
+    static constexpr std::uintptr_t kEndFlag = 1;
+    static constexpr std::uintptr_t kSpareFlag = 2;
+
     Node(T data, Node<T, Compare, Allocator> *parent);
     explicit Node(Node<T, Compare, Allocator>* parent, bool is_end=true);
     Node(const Node<T, Compare, Allocator>& node, const Allocator& alloc=Allocator(), Node<T, Compare, Allocator>* parent=nullptr);
@@ -9,15 +46,34 @@ struct Node {
     bool operator==(Node<T, Compare, Allocator> const& node);
     bool operator!=(Node<T, Compare, Allocator> const& node);
 
-    bool is_end_ = false;
+    bool is_end() const { return parent_.test(kEndFlag); }
+
     T data_;
     Node<T, Compare, Allocator>* left_= nullptr;
     Node<T, Compare, Allocator>* right_= nullptr;
-    Node<T, Compare, Allocator>* parent_= nullptr;
+    TaggedPointer<Node<T, Compare, Allocator>> parent_;
 };
 
+// Bytes a node spends on its key, its links and padding, for checking the layout per key type.
+template<typename T>
+struct NodeLayout {
+    static constexpr std::size_t kSize = sizeof(Node<T>);
+    static constexpr std::size_t kKeyBytes = sizeof(T);
+    static constexpr std::size_t kLinkBytes = 3 * sizeof(void*);
+    static constexpr std::size_t kPaddingBytes = kSize - kKeyBytes - kLinkBytes;
+};
+
+static_assert(alignof(Node<char>) > TaggedPointer<Node<char>>::kFlagMask, "node addresses must leave the flag bits free");
+static_assert(NodeLayout<char>::kPaddingBytes < alignof(void*));
+static_assert(NodeLayout<int>::kPaddingBytes < alignof(void*));
+static_assert(NodeLayout<long long>::kPaddingBytes == 0);
+static_assert(NodeLayout<double>::kPaddingBytes == 0);
+static_assert(NodeLayout<std::string>::kPaddingBytes == 0);
+
 template<typename T, class Compare, class Allocator>
-Node<T, Compare, Allocator>::Node(Node* parent, bool is_end) : parent_(parent), is_end_(is_end) {}
+Node<T, Compare, Allocator>::Node(Node* parent, bool is_end) : parent_(parent) {
+    parent_.set(kEndFlag, is_end);
+}
 
 template<typename T, class Compare, class Allocator>
 Node<T, Compare, Allocator>::Node(T data, Node* parent) : data_(data), left_(nullptr), right_(nullptr), parent_(parent) {}
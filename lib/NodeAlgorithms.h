@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cstdint>
+
+// Links of nodes allocated one by one: a handle is the node's address.
+template<class NodeType>
+struct PointerLinks {
+    typedef NodeType* handle;
+
+    static constexpr handle nil = nullptr;
+
+    handle& left(handle node) const { return node->left_; }
+    handle& right(handle node) const { return node->right_; }
+    handle& parent(handle node) const { return node->parent_; }
+};
+
+// Links of nodes kept in one array: a handle is the node's index. Valid until the array moves.
+template<class NodeType>
+struct ArenaLinks {
+    typedef std::uint32_t handle;
+
+    static constexpr handle nil = NodeType::kNil;
+
+    NodeType* nodes;
+
+    handle& left(handle node) const { return nodes[node].left_; }
+    handle& right(handle node) const { return nodes[node].right_; }
+    handle& parent(handle node) const { return nodes[node].parent_; }
+};
+
+// Algorithms on binary trees whose nodes link to their parent, shared by the trees that keep their own
+// node types. Links says how to follow a handle to the left, right and parent links; Links::nil stands
+// for a missing node and for the end position. None of them recurses, so an unbalanced tree of any
+// depth is fine.
+template<class Links>
+struct NodeAlgorithms {
+    typedef Links::handle handle;
+
+    static constexpr handle nil = Links::nil;
+
+    static handle minimum(Links links, handle node);
+    static handle maximum(Links links, handle node);
+    // In-order neighbours; nil past either end.
+    static handle successor(Links links, handle node);
+    static handle predecessor(Links links, handle node);
+
+    // Pre-order and post-order neighbours, nil past either end. The pre-order walk starts at the root
+    // and the post-order walk ends there.
+    static handle preorder_successor(Links links, handle node);
+    static handle preorder_predecessor(Links links, handle node);
+    static handle preorder_last(Links links, handle root);
+    static handle postorder_successor(Links links, handle node);
+    static handle postorder_predecessor(Links links, handle node);
+    static handle postorder_first(Links links, handle root);
+
+    // Puts `replacement` (possibly nil) where `node` hangs from its parent, or in `root`.
+    static void transplant(Links links, handle& root, handle node, handle replacement);
+    // Takes `node` out of the tree without moving any other node's key, so handles to them stay valid.
+    static void unlink(Links links, handle& root, handle node);
+
+    // Copies the tree under `source` and returns the copy's root. make_node(source_node, parent_copy)
+    // creates the copy of one node with its children nil. `links` must reach the nodes of both trees,
+    // as PointerLinks does.
+    template<class MakeNode>
+    static handle copy(Links links, handle source, MakeNode make_node);
+    // Calls destroy_node on every node of the tree under `root`, children before their parent.
+    template<class DestroyNode>
+    static void destroy(Links links, handle root, DestroyNode destroy_node);
+};
+
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::minimum(Links links, handle node) {
+    if (node == nil) {
+        return nil;
+    }
+    while (links.left(node) != nil) {
+        node = links.left(node);
+    }
+    return node;
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::maximum(Links links, handle node) {
+    if (node == nil) {
+        return nil;
+    }
+    while (links.right(node) != nil) {
+        node = links.right(node);
+    }
+    return node;
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::successor(Links links, handle node) {
+    if (links.right(node) != nil) {
+        return minimum(links, links.right(node));
+    }
+    handle parent = links.parent(node);
+    while (parent != nil && links.right(parent) == node) {
+        node = parent;
+        parent = links.parent(parent);
+    }
+    return parent;
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::predecessor(Links links, handle node) {
+    if (links.left(node) != nil) {
+        return maximum(links, links.left(node));
+    }
+    handle parent = links.parent(node);
+    while (parent != nil && links.left(parent) == node) {
+        node = parent;
+        parent = links.parent(parent);
+    }
+    return parent;
+}
+
+// The next node is the first child, or else the right child of the nearest ancestor that has one and
+// was reached from its left.
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::preorder_successor(Links links, handle node) {
+    if (links.left(node) != nil) {
+        return links.left(node);
+    }
+    if (links.right(node) != nil) {
+        return links.right(node);
+    }
+    for (handle parent = links.parent(node); parent != nil; node = parent, parent = links.parent(parent)) {
+        if (links.left(parent) == node && links.right(parent) != nil) {
+            return links.right(parent);
+        }
+    }
+    return nil;
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::preorder_predecessor(Links links, handle node) {
+    handle parent = links.parent(node);
+    if (parent == nil || links.left(parent) == node || links.left(parent) == nil) {
+        return parent;
+    }
+    return preorder_last(links, links.left(parent));
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::preorder_last(Links links, handle root) {
+    if (root == nil) {
+        return nil;
+    }
+    while (true) {
+        if (links.right(root) != nil) {
+            root = links.right(root);
+        } else if (links.left(root) != nil) {
+            root = links.left(root);
+        } else {
+            return root;
+        }
+    }
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::postorder_successor(Links links, handle node) {
+    handle parent = links.parent(node);
+    if (parent == nil || links.right(parent) == node || links.right(parent) == nil) {
+        return parent;
+    }
+    return postorder_first(links, links.right(parent));
+}
+
+// Mirrors preorder_successor: the last child, or else the left child of the nearest ancestor that has
+// one and was reached from its right.
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::postorder_predecessor(Links links, handle node) {
+    if (links.right(node) != nil) {
+        return links.right(node);
+    }
+    if (links.left(node) != nil) {
+        return links.left(node);
+    }
+    for (handle parent = links.parent(node); parent != nil; node = parent, parent = links.parent(parent)) {
+        if (links.right(parent) == node && links.left(parent) != nil) {
+            return links.left(parent);
+        }
+    }
+    return nil;
+}
+
+template<class Links>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::postorder_first(Links links, handle root) {
+    if (root == nil) {
+        return nil;
+    }
+    while (true) {
+        if (links.left(root) != nil) {
+            root = links.left(root);
+        } else if (links.right(root) != nil) {
+            root = links.right(root);
+        } else {
+            return root;
+        }
+    }
+}
+
+template<class Links>
+void NodeAlgorithms<Links>::transplant(Links links, handle& root, handle node, handle replacement) {
+    handle parent = links.parent(node);
+    if (parent == nil) {
+        root = replacement;
+    } else if (links.left(parent) == node) {
+        links.left(parent) = replacement;
+    } else {
+        links.right(parent) = replacement;
+    }
+    if (replacement != nil) {
+        links.parent(replacement) = parent;
+    }
+}
+
+// A node with two children is replaced by its successor, the leftmost node of its right subtree.
+template<class Links>
+void NodeAlgorithms<Links>::unlink(Links links, handle& root, handle node) {
+    if (links.left(node) == nil) {
+        transplant(links, root, node, links.right(node));
+    } else if (links.right(node) == nil) {
+        transplant(links, root, node, links.left(node));
+    } else {
+        handle next = minimum(links, links.right(node));
+        if (links.parent(next) != node) {
+            transplant(links, root, next, links.right(next));
+            links.right(next) = links.right(node);
+            links.parent(links.right(next)) = next;
+        }
+        transplant(links, root, node, next);
+        links.left(next) = links.left(node);
+        links.parent(links.left(next)) = next;
+    }
+}
+
+// Pre-order walk over the parent links of the source: each node is copied under the copy of its
+// parent, and the walk climbs back up through both trees together.
+template<class Links>
+template<class MakeNode>
+NodeAlgorithms<Links>::handle NodeAlgorithms<Links>::copy(Links links, handle source, MakeNode make_node) {
+    if (source == nil) {
+        return nil;
+    }
+    handle root = source;
+    handle copy_root = make_node(source, nil);
+    handle copy = copy_root;
+    while (true) {
+        if (links.left(source) != nil && links.left(copy) == nil) {
+            source = links.left(source);
+            copy = links.left(copy) = make_node(source, copy);
+        } else if (links.right(source) != nil && links.right(copy) == nil) {
+            source = links.right(source);
+            copy = links.right(copy) = make_node(source, copy);
+        } else if (source != root) {
+            source = links.parent(source);
+            copy = links.parent(copy);
+        } else {
+            return copy_root;
+        }
+    }
+}
+
+// Frees leaves bottom-up over the parent links, detaching each from its parent first.
+template<class Links>
+template<class DestroyNode>
+void NodeAlgorithms<Links>::destroy(Links links, handle root, DestroyNode destroy_node) {
+    handle node = root;
+    while (node != nil) {
+        if (links.left(node) != nil) {
+            node = links.left(node);
+        } else if (links.right(node) != nil) {
+            node = links.right(node);
+        } else {
+            handle parent = node == root ? nil : links.parent(node);
+            if (parent != nil) {
+                (links.left(parent) == node ? links.left(parent) : links.right(parent)) = nil;
+            }
+            destroy_node(node);
+            node = parent;
+        }
+    }
+}
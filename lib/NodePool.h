@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "HugePages.h"
+#include "MemoryUsage.h"
+
+// Contiguous blocks of node storage owned by a tree. Slots that hold no node are kept on a free list
+// threaded through the slots themselves, so create() and destroy() of pooled nodes never call the
+// allocator. destroy() also accepts nodes that were allocated on their own with new. Blocks stay
+// allocated until shrink_to_fit() finds every slot in them free. The block table is sorted by address,
+// so destroy() and owns() find a node's block by binary search however many batches added blocks.
+//
+// With huge pages enabled, blocks are mapped with map_huge_pages() and fill their whole 2 MiB pages,
+// and create() grows the pool by slabs instead of allocating single nodes.
+template<class NodeType>
+class NodePool {
+public:
+    typedef unsigned long long size_type;
+
+    NodePool() = default;
+    NodePool(const NodePool<NodeType>& other) = delete;
+    NodePool(NodePool<NodeType>&& other) noexcept;
+    ~NodePool();
+
+    NodePool<NodeType>& operator=(const NodePool<NodeType>& other) = delete;
+    NodePool<NodeType>& operator=(NodePool<NodeType>&& other) noexcept;
+
+    // Uninitialised storage for `count` nodes; the caller constructs each of them. Slots past `count`
+    // that a huge page mapping rounds up to become free.
+    NodeType* allocate_block(size_type count);
+    // Adds one block if needed so that at least `count` slots are free.
+    void reserve(size_type count);
+    template<class... Args>
+    NodeType* create(Args&&... args);
+    void destroy(NodeType* node);
+    void shrink_to_fit();
+    bool owns(const NodeType* node) const;
+    // Applies to blocks allocated from now on.
+    void set_huge_pages(bool enable) noexcept;
+    [[nodiscard]] bool huge_pages() const noexcept;
+
+    [[nodiscard]] size_type block_count() const noexcept;
+    [[nodiscard]] size_type free_count() const noexcept;
+    // Slots in all blocks, used or free.
+    [[nodiscard]] size_type slot_count() const noexcept;
+    // Allocator overhead of the blocks and their bookkeeping, see heap_overhead().
+    [[nodiscard]] size_type overhead_bytes() const noexcept;
+    // Bytes of blocks mapped with the given backing.
+    [[nodiscard]] size_type mapped_bytes(PageBacking backing) const noexcept;
+
+    void swap(NodePool<NodeType>& other) noexcept;
+
+private:
+    struct Block {
+        NodeType* nodes_ = nullptr;
+        size_type capacity_ = 0;
+        // Empty for blocks from operator new.
+        PageRegion region_;
+    };
+
+    struct FreeSlot {
+        FreeSlot* next_;
+    };
+
+    static_assert(sizeof(NodeType) >= sizeof(FreeSlot) && alignof(NodeType) >= alignof(FreeSlot));
+
+    // Sorted by nodes_.
+    std::unique_ptr<Block[]> blocks_;
+    size_type block_count_ = 0;
+    size_type block_capacity_ = 0;
+    FreeSlot* free_ = nullptr;
+    size_type free_count_ = 0;
+    size_type slot_count_ = 0;
+    size_type overhead_bytes_ = 0;
+    bool huge_pages_ = false;
+
+    Block* new_block(size_type count);
+    // Inserts the block at its place in address order.
+    Block* add_block(const Block& block);
+    Block* find_block(const void* slot) const;
+    void push_free(NodeType* slot) noexcept;
+
+    void free_block(const Block& block);
+
+    static size_type block_overhead(const Block& block);
+};
+
+
+template<class NodeType>
+NodePool<NodeType>::NodePool(NodePool<NodeType>&& other) noexcept {
+    swap(other);
+}
+
+// Storage of nodes that were never destroyed, such as ones erase() unlinked, goes with the pool.
+template<class NodeType>
+NodePool<NodeType>::~NodePool() {
+    for (size_type i = 0; i < block_count_; ++i) {
+        free_block(blocks_[i]);
+    }
+}
+
+template<class NodeType>
+NodePool<NodeType>& NodePool<NodeType>::operator=(NodePool<NodeType>&& other) noexcept {
+    NodePool<NodeType> moved(std::move(other));
+    swap(moved);
+    return *this;
+}
+
+template<class NodeType>
+NodeType* NodePool<NodeType>::allocate_block(size_type count) {
+    Block* block = new_block(count);
+    for (size_type i = block->capacity_; i > count; --i) {
+        push_free(block->nodes_ + i - 1);
+    }
+    return block->nodes_;
+}
+
+// Slots are pushed from the back so that create() fills the block from its start.
+template<class NodeType>
+void NodePool<NodeType>::reserve(size_type count) {
+    if (free_count_ >= count) {
+        return;
+    }
+    Block* block = new_block(count - free_count_);
+    for (size_type i = block->capacity_; i > 0; --i) {
+        push_free(block->nodes_ + i - 1);
+    }
+}
+
+template<class NodeType>
+template<class... Args>
+NodeType* NodePool<NodeType>::create(Args&&... args) {
+    if (free_ == nullptr) {
+        if (!huge_pages_) {
+            return new NodeType(std::forward<Args>(args)...);
+        }
+        // Each slab at least doubles the pool, so the pool holds few blocks.
+        reserve(slot_count_ == 0 ? 1 : slot_count_);
+    }
+    FreeSlot* slot = free_;
+    free_ = slot->next_;
+    --free_count_;
+    return new (static_cast<void*>(slot)) NodeType(std::forward<Args>(args)...);
+}
+
+template<class NodeType>
+void NodePool<NodeType>::destroy(NodeType* node) {
+    if (find_block(node) == nullptr) {
+        delete node;
+        return;
+    }
+    node->~NodeType();
+    push_free(node);
+}
+
+// Counts the free slots of every block in one pass over the free list, then unlinks the slots of the
+// blocks that are entirely free in a second pass, so the cost is O(free * log blocks).
+template<class NodeType>
+void NodePool<NodeType>::shrink_to_fit() {
+    if (block_count_ == 0) {
+        return;
+    }
+    std::unique_ptr<size_type[]> free_in_block(new size_type[block_count_]());
+    for (const FreeSlot* slot = free_; slot != nullptr; slot = slot->next_) {
+        ++free_in_block[find_block(slot) - blocks_.get()];
+    }
+    FreeSlot** link = &free_;
+    while (*link != nullptr) {
+        const Block* block = find_block(*link);
+        if (free_in_block[block - blocks_.get()] == block->capacity_) {
+            *link = (*link)->next_;
+            --free_count_;
+        } else {
+            link = &(*link)->next_;
+        }
+    }
+
+    size_type kept = 0;
+    for (size_type i = 0; i < block_count_; ++i) {
+        if (free_in_block[i] == blocks_[i].capacity_) {
+            free_block(blocks_[i]);
+        } else {
+            blocks_[kept++] = blocks_[i];
+        }
+    }
+    block_count_ = kept;
+    if (block_count_ < block_capacity_) {
+        std::unique_ptr<Block[]> fitted(block_count_ == 0 ? nullptr : new Block[block_count_]);
+        std::copy(blocks_.get(), blocks_.get() + block_count_, fitted.get());
+        blocks_ = std::move(fitted);
+        block_capacity_ = block_count_;
+    }
+}
+
+template<class NodeType>
+bool NodePool<NodeType>::owns(const NodeType* node) const {
+    return find_block(node) != nullptr;
+}
+
+template<class NodeType>
+void NodePool<NodeType>::set_huge_pages(bool enable) noexcept {
+    huge_pages_ = enable;
+}
+
+template<class NodeType>
+bool NodePool<NodeType>::huge_pages() const noexcept {
+    return huge_pages_;
+}
+
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::block_count() const noexcept {
+    return block_count_;
+}
+
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::free_count() const noexcept {
+    return free_count_;
+}
+
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::slot_count() const noexcept {
+    return slot_count_;
+}
+
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::overhead_bytes() const noexcept {
+    if (block_capacity_ == 0) {
+        return overhead_bytes_;
+    }
+    return overhead_bytes_ + block_capacity_ * sizeof(Block) + heap_overhead(block_capacity_ * sizeof(Block));
+}
+
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::mapped_bytes(PageBacking backing) const noexcept {
+    size_type bytes = 0;
+    for (size_type i = 0; i < block_count_; ++i) {
+        if (blocks_[i].region_.data != nullptr && blocks_[i].region_.backing == backing) {
+            bytes += blocks_[i].region_.size;
+        }
+    }
+    return bytes;
+}
+
+template<class NodeType>
+void NodePool<NodeType>::swap(NodePool<NodeType>& other) noexcept {
+    std::swap(blocks_, other.blocks_);
+    std::swap(block_count_, other.block_count_);
+    std::swap(block_capacity_, other.block_capacity_);
+    std::swap(free_, other.free_);
+    std::swap(free_count_, other.free_count_);
+    std::swap(slot_count_, other.slot_count_);
+    std::swap(overhead_bytes_, other.overhead_bytes_);
+    std::swap(huge_pages_, other.huge_pages_);
+}
+
+template<class NodeType>
+NodePool<NodeType>::Block* NodePool<NodeType>::new_block(size_type count) {
+    if (block_count_ == block_capacity_) {
+        size_type capacity = block_capacity_ == 0 ? 1 : block_capacity_ * 2;
+        std::unique_ptr<Block[]> grown(new Block[capacity]);
+        std::copy(blocks_.get(), blocks_.get() + block_count_, grown.get());
+        blocks_ = std::move(grown);
+        block_capacity_ = capacity;
+    }
+    Block block;
+    if (huge_pages_) {
+        block.region_ = map_huge_pages(count * sizeof(NodeType));
+    }
+    if (block.region_.data != nullptr) {
+        block.nodes_ = static_cast<NodeType*>(block.region_.data);
+        block.capacity_ = block.region_.size / sizeof(NodeType);
+    } else {
+        block.nodes_ = static_cast<NodeType*>(::operator new(count * sizeof(NodeType), std::align_val_t(alignof(NodeType))));
+        block.capacity_ = count;
+    }
+    return add_block(block);
+}
+
+template<class NodeType>
+NodePool<NodeType>::Block* NodePool<NodeType>::add_block(const Block& block) {
+    Block* end = blocks_.get() + block_count_;
+    Block* position = std::upper_bound(blocks_.get(), end, block.nodes_, [](const NodeType* nodes, const Block& other) {
+        return std::less<const NodeType*>()(nodes, other.nodes_);
+    });
+    std::copy_backward(position, end, end + 1);
+    *position = block;
+    ++block_count_;
+    slot_count_ += block.capacity_;
+    overhead_bytes_ += block_overhead(block);
+    return position;
+}
+
+// std::less gives a total order over pointers into different blocks, which < does not.
+template<class NodeType>
+NodePool<NodeType>::Block* NodePool<NodeType>::find_block(const void* slot) const {
+    std::less<const void*> less;
+    Block* end = blocks_.get() + block_count_;
+    Block* after = std::upper_bound(blocks_.get(), end, slot, [&less](const void* target, const Block& block) {
+        return less(target, block.nodes_);
+    });
+    if (after == blocks_.get()) {
+        return nullptr;
+    }
+    Block* block = after - 1;
+    return less(slot, block->nodes_ + block->capacity_) ? block : nullptr;
+}
+
+template<class NodeType>
+void NodePool<NodeType>::push_free(NodeType* slot) noexcept {
+    free_ = new (static_cast<void*>(slot)) FreeSlot{free_};
+    ++free_count_;
+}
+
+template<class NodeType>
+void NodePool<NodeType>::free_block(const Block& block) {
+    slot_count_ -= block.capacity_;
+    overhead_bytes_ -= block_overhead(block);
+    if (block.region_.data != nullptr) {
+        unmap_pages(block.region_);
+    } else {
+        ::operator delete(block.nodes_, std::align_val_t(alignof(NodeType)));
+    }
+}
+
+// The block table itself is counted in overhead_bytes().
+template<class NodeType>
+NodePool<NodeType>::size_type NodePool<NodeType>::block_overhead(const Block& block) {
+    size_type bytes = block.capacity_ * sizeof(NodeType);
+    return block.region_.data != nullptr ? block.region_.size - bytes : heap_overhead(bytes);
+}
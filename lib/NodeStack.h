@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+// Stack of node pointers that keeps its first kInlineCapacity entries inside the object, so the
+// root-to-node paths of trees up to that depth never touch the heap.
+template<class NodeType>
+class NodeStack {
+public:
+    typedef unsigned long long size_type;
+
+    static constexpr size_type kInlineCapacity = 32;
+
+    NodeStack() = default;
+    NodeStack(const NodeStack<NodeType>& other);
+    NodeStack(NodeStack<NodeType>&& other) noexcept;
+    ~NodeStack();
+
+    NodeStack<NodeType>& operator=(const NodeStack<NodeType>& other);
+    NodeStack<NodeType>& operator=(NodeStack<NodeType>&& other) noexcept;
+
+    void push(NodeType* node);
+    NodeType* pop();
+    NodeType* top() const;
+    NodeType* operator[](size_type index) const;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    void clear() noexcept;
+
+private:
+    NodeType* inline_[kInlineCapacity];
+    NodeType** data_ = inline_;
+    size_type size_ = 0;
+    size_type capacity_ = kInlineCapacity;
+
+    // Leaves the stack empty on the inline buffer.
+    void release() noexcept;
+};
+
+template<class NodeType>
+NodeStack<NodeType>::NodeStack(const NodeStack<NodeType>& other) {
+    if (other.size_ > kInlineCapacity) {
+        data_ = new NodeType*[other.size_];
+        capacity_ = other.size_;
+    }
+    size_ = other.size_;
+    for (size_type i = 0; i < size_; ++i) {
+        data_[i] = other.data_[i];
+    }
+}
+
+template<class NodeType>
+NodeStack<NodeType>::NodeStack(NodeStack<NodeType>&& other) noexcept {
+    *this = std::move(other);
+}
+
+template<class NodeType>
+NodeStack<NodeType>::~NodeStack() {
+    release();
+}
+
+template<class NodeType>
+NodeStack<NodeType>& NodeStack<NodeType>::operator=(const NodeStack<NodeType>& other) {
+    if (this != &other) {
+        NodeStack<NodeType> copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template<class NodeType>
+NodeStack<NodeType>& NodeStack<NodeType>::operator=(NodeStack<NodeType>&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    release();
+    if (other.data_ != other.inline_) {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+    } else {
+        for (size_type i = 0; i < other.size_; ++i) {
+            data_[i] = other.data_[i];
+        }
+    }
+    size_ = other.size_;
+    other.data_ = other.inline_;
+    other.size_ = 0;
+    other.capacity_ = kInlineCapacity;
+    return *this;
+}
+
+template<class NodeType>
+void NodeStack<NodeType>::push(NodeType* node) {
+    if (size_ == capacity_) {
+        size_type capacity = capacity_ * 2;
+        NodeType** data = new NodeType*[capacity];
+        for (size_type i = 0; i < size_; ++i) {
+            data[i] = data_[i];
+        }
+        if (data_ != inline_) {
+            delete[] data_;
+        }
+        data_ = data;
+        capacity_ = capacity;
+    }
+    data_[size_++] = node;
+}
+
+template<class NodeType>
+NodeType* NodeStack<NodeType>::pop() {
+    return data_[--size_];
+}
+
+template<class NodeType>
+NodeType* NodeStack<NodeType>::top() const {
+    return size_ == 0 ? nullptr : data_[size_ - 1];
+}
+
+template<class NodeType>
+NodeType* NodeStack<NodeType>::operator[](size_type index) const {
+    return data_[index];
+}
+
+template<class NodeType>
+bool NodeStack<NodeType>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class NodeType>
+NodeStack<NodeType>::size_type NodeStack<NodeType>::size() const noexcept {
+    return size_;
+}
+
+template<class NodeType>
+void NodeStack<NodeType>::clear() noexcept {
+    size_ = 0;
+}
+
+template<class NodeType>
+void NodeStack<NodeType>::release() noexcept {
+    if (data_ != inline_) {
+        delete[] data_;
+    }
+    data_ = inline_;
+    size_ = 0;
+    capacity_ = kInlineCapacity;
+}
@@ -0,0 +1,571 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "NodeStack.h"
+
+template<typename T>
+struct ParentFreeNode {
+    explicit ParentFreeNode(const T& data) : data_(data) {}
+
+    T data_;
+    ParentFreeNode<T>* left_ = nullptr;
+    ParentFreeNode<T>* right_ = nullptr;
+};
+
+// Unbalanced binary search tree with the interface of BinarySearchTree whose nodes have no parent
+// link: a node of int keys takes 24 bytes instead of 32, and inserts and erases write only the one
+// child link they change. Iterators carry the path from the root instead, so they are heavier to copy,
+// and insert and erase invalidate all of them. for_each() walks the whole tree in O(1) extra memory.
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class ParentFreeBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Allocator allocator_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef ParentFreeNode<Key> node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    ParentFreeBinarySearchTree() = default;
+    explicit ParentFreeBinarySearchTree(const Allocator& alloc);
+    template<class InputIt>
+    ParentFreeBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    ParentFreeBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+    ParentFreeBinarySearchTree(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& other);
+    ParentFreeBinarySearchTree(ParentFreeBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+    ~ParentFreeBinarySearchTree();
+
+    ParentFreeBinarySearchTree<Key, Compare, Allocator>& operator=(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& other);
+    ParentFreeBinarySearchTree<Key, Compare, Allocator>& operator=(ParentFreeBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+    ParentFreeBinarySearchTree<Key, Compare, Allocator>& operator=(std::initializer_list<value_type> ilist);
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    // Visits every key in order by Morris traversal, which threads and unthreads the tree as it goes,
+    // so it must not run concurrently with any other access.
+    template<class Function>
+    void for_each(Function function) const;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    iterator insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const Key& key);
+    void swap(ParentFreeBinarySearchTree<Key, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+    bool operator==(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& rhs) const;
+    bool operator!=(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<node_type> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+
+    node_type* root_ = nullptr;
+    size_type size_ = 0;
+    [[no_unique_address]] node_allocator node_allocator_;
+
+    node_type* make_node(const value_type& value);
+    void destroy(node_type* node);
+    // Keeps the prefix of a descent path that ends at its index-th node.
+    static NodeStack<node_type> cut(NodeStack<node_type> path, size_type index);
+};
+
+// Holds the path from the root to the current node; end() has an empty path.
+template<class Key, class Compare, class Allocator>
+class ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const ParentFreeBinarySearchTree<Key, Compare, Allocator>* tree, NodeStack<node_type> path) : tree_(tree), path_(std::move(path)) {}
+
+    reference operator*() const { return path_.top()->data_; }
+    pointer operator->() const { return &path_.top()->data_; }
+
+    const_iterator& operator++() {
+        if (path_.top()->right_ != nullptr) {
+            for (node_type* node = path_.top()->right_; node != nullptr; node = node->left_) {
+                path_.push(node);
+            }
+            return *this;
+        }
+        node_type* child = path_.pop();
+        while (!path_.empty() && path_.top()->right_ == child) {
+            child = path_.pop();
+        }
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        node_type* left = path_.empty() ? tree_->root_ : path_.top()->left_;
+        if (left != nullptr) {
+            for (node_type* node = left; node != nullptr; node = node->right_) {
+                path_.push(node);
+            }
+            return *this;
+        }
+        node_type* child = path_.pop();
+        while (!path_.empty() && path_.top()->left_ == child) {
+            child = path_.pop();
+        }
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return path_.top() == other.path_.top(); }
+    bool operator!=(const const_iterator& other) const { return path_.top() != other.path_.top(); }
+
+    const NodeStack<node_type>& path() const { return path_; }
+
+private:
+    const ParentFreeBinarySearchTree<Key, Compare, Allocator>* tree_ = nullptr;
+    NodeStack<node_type> path_;
+};
+
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::ParentFreeBinarySearchTree(const Allocator& alloc) : node_allocator_(alloc) {}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::ParentFreeBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : ParentFreeBinarySearchTree<Key, Compare, Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::ParentFreeBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : ParentFreeBinarySearchTree<Key, Compare, Allocator>(init.begin(), init.end(), alloc) {}
+
+// Copies in preorder with explicit stacks, since an unbalanced tree can be too deep to recurse over.
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::ParentFreeBinarySearchTree(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& other)
+        : node_allocator_(node_traits::select_on_container_copy_construction(other.node_allocator_)) {
+    if (other.root_ == nullptr) {
+        return;
+    }
+    root_ = make_node(other.root_->data_);
+    NodeStack<node_type> sources;
+    NodeStack<node_type> copies;
+    sources.push(other.root_);
+    copies.push(root_);
+    while (!sources.empty()) {
+        node_type* source = sources.pop();
+        node_type* copy = copies.pop();
+        if (source->left_ != nullptr) {
+            copy->left_ = make_node(source->left_->data_);
+            sources.push(source->left_);
+            copies.push(copy->left_);
+        }
+        if (source->right_ != nullptr) {
+            copy->right_ = make_node(source->right_->data_);
+            sources.push(source->right_);
+            copies.push(copy->right_);
+        }
+    }
+    size_ = other.size_;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::ParentFreeBinarySearchTree(ParentFreeBinarySearchTree<Key, Compare, Allocator>&& other) noexcept
+        : node_allocator_(other.node_allocator_) {
+    swap(other);
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::~ParentFreeBinarySearchTree() {
+    clear();
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>& ParentFreeBinarySearchTree<Key, Compare, Allocator>::operator=(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& other) {
+    if (this != &other) {
+        ParentFreeBinarySearchTree<Key, Compare, Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>& ParentFreeBinarySearchTree<Key, Compare, Allocator>::operator=(ParentFreeBinarySearchTree<Key, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>& ParentFreeBinarySearchTree<Key, Compare, Allocator>::operator=(std::initializer_list<value_type> ilist) {
+    clear();
+    insert(ilist);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::allocator_type ParentFreeBinarySearchTree<Key, Compare, Allocator>::get_allocator() const noexcept {
+    return allocator_type(node_allocator_);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::begin() const {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr; node = node->left_) {
+        path.push(node);
+    }
+    return const_iterator(this, std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::end() const {
+    return const_iterator(this, NodeStack<node_type>());
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::cbegin() const {
+    return begin();
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::cend() const {
+    return end();
+}
+
+// Before a left subtree is visited, the rightmost node in it gets a thread back to the subtree's root
+// in its empty right link; following that thread later marks the left subtree as done and removes it.
+template<class Key, class Compare, class Allocator>
+template<class Function>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::for_each(Function function) const {
+    node_type* node = root_;
+    while (node != nullptr) {
+        if (node->left_ == nullptr) {
+            function(node->data_);
+            node = node->right_;
+            continue;
+        }
+        node_type* predecessor = node->left_;
+        while (predecessor->right_ != nullptr && predecessor->right_ != node) {
+            predecessor = predecessor->right_;
+        }
+        if (predecessor->right_ == nullptr) {
+            predecessor->right_ = node;
+            node = node->left_;
+        } else {
+            predecessor->right_ = nullptr;
+            function(node->data_);
+            node = node->right_;
+        }
+    }
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare, class Allocator>
+bool ParentFreeBinarySearchTree<Key, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::size_type ParentFreeBinarySearchTree<Key, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+
+// Implementation of modifiers
+
+// Rotates left children up until the root has none, then frees it, so no stack is needed.
+template<class Key, class Compare, class Allocator>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::clear() noexcept {
+    node_type* node = root_;
+    while (node != nullptr) {
+        if (node->left_ != nullptr) {
+            node_type* left = node->left_;
+            node->left_ = left->right_;
+            left->right_ = node;
+            node = left;
+        } else {
+            node_type* right = node->right_;
+            destroy(node);
+            node = right;
+        }
+    }
+    root_ = nullptr;
+    size_ = 0;
+}
+
+// Equal keys are inserted before the existing ones, as in BinarySearchTree.
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::insert(const value_type& value) {
+    NodeStack<node_type> path;
+    node_type** link = &root_;
+    while (*link != nullptr) {
+        path.push(*link);
+        link = Compare()((*link)->data_, value) ? &(*link)->right_ : &(*link)->left_;
+    }
+    *link = make_node(value);
+    path.push(*link);
+    ++size_;
+    return iterator(this, std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+// The iterator's path supplies the parent. The path to the successor is worked out from it before
+// the tree changes; relinking leaves the nodes on that path in place.
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::erase(const_iterator pos) {
+    NodeStack<node_type> path = pos.path();
+    node_type* node = path.pop();
+    node_type* parent = path.top();
+    node_type*& link = parent == nullptr ? root_ : parent->left_ == node ? parent->left_ : parent->right_;
+
+    if (node->left_ != nullptr && node->right_ != nullptr) {
+        // The successor, leftmost in the right subtree, takes the erased node's place.
+        node_type* successor_parent = node;
+        node_type* successor = node->right_;
+        while (successor->left_ != nullptr) {
+            successor_parent = successor;
+            successor = successor->left_;
+        }
+        if (successor_parent != node) {
+            successor_parent->left_ = successor->right_;
+            successor->right_ = node->right_;
+        }
+        successor->left_ = node->left_;
+        link = successor;
+        path.push(successor);
+    } else if (node->right_ != nullptr) {
+        link = node->right_;
+        for (node_type* next = node->right_; next != nullptr; next = next->left_) {
+            path.push(next);
+        }
+    } else {
+        node_type* child = node;
+        while (!path.empty() && path.top()->right_ == child) {
+            child = path.pop();
+        }
+        link = node->left_;
+    }
+
+    destroy(node);
+    --size_;
+    return iterator(this, std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::erase(const_iterator first, const_iterator last) {
+    // Erasing invalidates `last`, so count the keys up to it first.
+    size_type count = 0;
+    for (const_iterator it = first; it != last; ++it) {
+        ++count;
+    }
+    for (; count > 0; --count) {
+        first = erase(first);
+    }
+    return first;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::size_type ParentFreeBinarySearchTree<Key, Compare, Allocator>::erase(const Key& key) {
+    size_type count = 0;
+    const_iterator it = lower_bound(key);
+    while (it != end() && !Compare()(key, *it)) {
+        it = erase(it);
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Compare, class Allocator>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::swap(ParentFreeBinarySearchTree<Key, Compare, Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(node_allocator_, other.node_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::size_type ParentFreeBinarySearchTree<Key, Compare, Allocator>::count(const Key& key) const {
+    size_type count = 0;
+    for (const_iterator it = lower_bound(key); it != end() && !Compare()(key, *it); ++it) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::find(const Key& key) const {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr;) {
+        path.push(node);
+        if (Compare()(node->data_, key)) {
+            node = node->right_;
+        } else if (Compare()(key, node->data_)) {
+            node = node->left_;
+        } else {
+            return const_iterator(this, std::move(path));
+        }
+    }
+    return end();
+}
+
+// Needs no path, so unlike find() it does not allocate.
+template<class Key, class Compare, class Allocator>
+bool ParentFreeBinarySearchTree<Key, Compare, Allocator>::contains(const Key& key) const {
+    node_type* node = root_;
+    while (node != nullptr) {
+        bool right = Compare()(node->data_, key);
+        if (!right && !Compare()(key, node->data_)) {
+            return true;
+        }
+        node = right ? node->right_ : node->left_;
+    }
+    return false;
+}
+
+template<class Key, class Compare, class Allocator>
+std::pair<typename ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator, typename ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator> ParentFreeBinarySearchTree<Key, Compare, Allocator>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::lower_bound(const Key& key) const {
+    NodeStack<node_type> path;
+    size_type result = 0;
+    for (node_type* node = root_; node != nullptr;) {
+        path.push(node);
+        if (Compare()(node->data_, key)) {
+            node = node->right_;
+        } else {
+            result = path.size();
+            node = node->left_;
+        }
+    }
+    return const_iterator(this, cut(std::move(path), result));
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::const_iterator ParentFreeBinarySearchTree<Key, Compare, Allocator>::upper_bound(const Key& key) const {
+    NodeStack<node_type> path;
+    size_type result = 0;
+    for (node_type* node = root_; node != nullptr;) {
+        path.push(node);
+        if (Compare()(key, node->data_)) {
+            result = path.size();
+            node = node->left_;
+        } else {
+            node = node->right_;
+        }
+    }
+    return const_iterator(this, cut(std::move(path), result));
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::key_compare ParentFreeBinarySearchTree<Key, Compare, Allocator>::key_comp() const {
+    return Compare();
+}
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::value_compare ParentFreeBinarySearchTree<Key, Compare, Allocator>::value_comp() const {
+    return Compare();
+}
+
+template<class Key, class Compare, class Allocator>
+bool ParentFreeBinarySearchTree<Key, Compare, Allocator>::operator==(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& rhs) const {
+    return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
+}
+
+template<class Key, class Compare, class Allocator>
+bool ParentFreeBinarySearchTree<Key, Compare, Allocator>::operator!=(const ParentFreeBinarySearchTree<Key, Compare, Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Compare, class Allocator>
+ParentFreeBinarySearchTree<Key, Compare, Allocator>::node_type* ParentFreeBinarySearchTree<Key, Compare, Allocator>::make_node(const value_type& value) {
+    node_type* node = node_traits::allocate(node_allocator_, 1);
+    node_traits::construct(node_allocator_, node, value);
+    return node;
+}
+
+template<class Key, class Compare, class Allocator>
+void ParentFreeBinarySearchTree<Key, Compare, Allocator>::destroy(node_type* node) {
+    node_traits::destroy(node_allocator_, node);
+    node_traits::deallocate(node_allocator_, node, 1);
+}
+
+template<class Key, class Compare, class Allocator>
+NodeStack<typename ParentFreeBinarySearchTree<Key, Compare, Allocator>::node_type> ParentFreeBinarySearchTree<Key, Compare, Allocator>::cut(NodeStack<node_type> path, size_type index) {
+    while (path.size() > index) {
+        path.pop();
+    }
+    return path;
+}
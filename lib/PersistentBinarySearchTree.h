@@ -0,0 +1,400 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+
+#include "NodeStack.h"
+
+template<typename T>
+struct PersistentNode {
+    PersistentNode(const T& data, PersistentNode<T>* left, PersistentNode<T>* right) : data_(data), left_(left), right_(right) {}
+
+    const T data_;
+    PersistentNode<T>* const left_;
+    PersistentNode<T>* const right_;
+    mutable std::atomic<unsigned long long> ref_count_ = 1;
+};
+
+// Nodes are immutable and shared between versions through reference counts: copying the tree or taking
+// a snapshot is O(1) and every update copies only the nodes on its root-to-node path. A snapshot stays
+// readable from other threads while the tree it was taken from keeps changing.
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class PersistentBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Allocator allocator_type;
+    typedef const value_type& const_reference;
+    typedef PersistentNode<Key> node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    PersistentBinarySearchTree() = default;
+    template<class InputIt>
+    PersistentBinarySearchTree(InputIt first, InputIt last);
+    PersistentBinarySearchTree(std::initializer_list<value_type> init);
+    PersistentBinarySearchTree(const PersistentBinarySearchTree<Key, Compare, Allocator>& other);
+    PersistentBinarySearchTree(PersistentBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+    ~PersistentBinarySearchTree();
+
+    PersistentBinarySearchTree<Key, Compare, Allocator>& operator=(const PersistentBinarySearchTree<Key, Compare, Allocator>& other);
+    PersistentBinarySearchTree<Key, Compare, Allocator>& operator=(PersistentBinarySearchTree<Key, Compare, Allocator>&& other) noexcept;
+
+    PersistentBinarySearchTree<Key, Compare, Allocator> snapshot() const;
+
+    // Iterators
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    void insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    size_type erase(const Key& key);
+    void swap(PersistentBinarySearchTree<Key, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+
+private:
+    node_type* root_ = nullptr;
+    size_type size_ = 0;
+
+    static node_type* acquire(node_type* node);
+    static void release(node_type* node);
+
+    bool erase_one(const Key& key);
+    node_type* copy_path(const NodeStack<node_type>& path, node_type* replacement, const Key& key);
+};
+
+template<class Key, class Compare, class Allocator>
+class PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    explicit const_iterator(NodeStack<node_type> path) : path_(std::move(path)) {}
+
+    reference operator*() const { return path_.top()->data_; }
+    pointer operator->() const { return &path_.top()->data_; }
+
+    const_iterator& operator++() {
+        node_type* node = path_.pop()->right_;
+        for (; node != nullptr; node = node->left_) {
+            path_.push(node);
+        }
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return path_.top() == other.path_.top(); }
+    bool operator!=(const const_iterator& other) const { return path_.top() != other.path_.top(); }
+
+private:
+    NodeStack<node_type> path_;
+};
+
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+PersistentBinarySearchTree<Key, Compare, Allocator>::PersistentBinarySearchTree(InputIt first, InputIt last) {
+    insert(first, last);
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::PersistentBinarySearchTree(std::initializer_list<value_type> init) : PersistentBinarySearchTree<Key, Compare, Allocator>(init.begin(), init.end()) {}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::PersistentBinarySearchTree(const PersistentBinarySearchTree<Key, Compare, Allocator>& other) : root_(acquire(other.root_)), size_(other.size_) {}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::PersistentBinarySearchTree(PersistentBinarySearchTree<Key, Compare, Allocator>&& other) noexcept : root_(other.root_), size_(other.size_) {
+    other.root_ = nullptr;
+    other.size_ = 0;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::~PersistentBinarySearchTree() {
+    release(root_);
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>& PersistentBinarySearchTree<Key, Compare, Allocator>::operator=(const PersistentBinarySearchTree<Key, Compare, Allocator>& other) {
+    node_type* root = acquire(other.root_);
+    release(root_);
+    root_ = root;
+    size_ = other.size_;
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>& PersistentBinarySearchTree<Key, Compare, Allocator>::operator=(PersistentBinarySearchTree<Key, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator> PersistentBinarySearchTree<Key, Compare, Allocator>::snapshot() const {
+    return *this;
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator PersistentBinarySearchTree<Key, Compare, Allocator>::begin() const {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr; node = node->left_) {
+        path.push(node);
+    }
+    return const_iterator(std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator PersistentBinarySearchTree<Key, Compare, Allocator>::end() const {
+    return const_iterator();
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare, class Allocator>
+bool PersistentBinarySearchTree<Key, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::size_type PersistentBinarySearchTree<Key, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+
+// Implementation of modifiers
+
+template<class Key, class Compare, class Allocator>
+void PersistentBinarySearchTree<Key, Compare, Allocator>::clear() noexcept {
+    release(root_);
+    root_ = nullptr;
+    size_ = 0;
+}
+
+template<class Key, class Compare, class Allocator>
+void PersistentBinarySearchTree<Key, Compare, Allocator>::insert(const value_type& value) {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr;) {
+        path.push(node);
+        node = Compare()(node->data_, value) ? node->right_ : node->left_;
+    }
+    node_type* root = copy_path(path, new node_type(value, nullptr, nullptr), value);
+    release(root_);
+    root_ = root;
+    ++size_;
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+void PersistentBinarySearchTree<Key, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::size_type PersistentBinarySearchTree<Key, Compare, Allocator>::erase(const Key& key) {
+    size_type counter = 0;
+    while (erase_one(key)) {
+        ++counter;
+    }
+    return counter;
+}
+
+template<class Key, class Compare, class Allocator>
+void PersistentBinarySearchTree<Key, Compare, Allocator>::swap(PersistentBinarySearchTree<Key, Compare, Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::size_type PersistentBinarySearchTree<Key, Compare, Allocator>::count(const Key& key) const {
+    size_type counter = 0;
+    for (node_type* node = root_; node != nullptr;) {
+        if (Compare()(node->data_, key)) {
+            node = node->right_;
+            continue;
+        }
+        if (!Compare()(key, node->data_)) {
+            ++counter;
+        }
+        node = node->left_;
+    }
+    return counter;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator PersistentBinarySearchTree<Key, Compare, Allocator>::find(const Key& key) const {
+    const_iterator it = lower_bound(key);
+    if (it != end() && Compare()(key, *it)) {
+        return end();
+    }
+    return it;
+}
+
+template<class Key, class Compare, class Allocator>
+bool PersistentBinarySearchTree<Key, Compare, Allocator>::contains(const Key& key) const {
+    for (node_type* node = root_; node != nullptr;) {
+        if (Compare()(node->data_, key)) {
+            node = node->right_;
+        } else if (Compare()(key, node->data_)) {
+            node = node->left_;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator PersistentBinarySearchTree<Key, Compare, Allocator>::lower_bound(const Key& key) const {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr;) {
+        if (Compare()(node->data_, key)) {
+            node = node->right_;
+        } else {
+            path.push(node);
+            node = node->left_;
+        }
+    }
+    return const_iterator(std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::const_iterator PersistentBinarySearchTree<Key, Compare, Allocator>::upper_bound(const Key& key) const {
+    NodeStack<node_type> path;
+    for (node_type* node = root_; node != nullptr;) {
+        if (Compare()(key, node->data_)) {
+            path.push(node);
+            node = node->left_;
+        } else {
+            node = node->right_;
+        }
+    }
+    return const_iterator(std::move(path));
+}
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::key_compare PersistentBinarySearchTree<Key, Compare, Allocator>::key_comp() const {
+    return key_compare();
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::node_type* PersistentBinarySearchTree<Key, Compare, Allocator>::acquire(node_type* node) {
+    if (node != nullptr) {
+        node->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+template<class Key, class Compare, class Allocator>
+void PersistentBinarySearchTree<Key, Compare, Allocator>::release(node_type* node) {
+    NodeStack<node_type> pending;
+    pending.push(node);
+    while (!pending.empty()) {
+        node = pending.pop();
+        if (node != nullptr && node->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pending.push(node->left_);
+            pending.push(node->right_);
+            delete node;
+        }
+    }
+}
+
+// Rebuilds the path from the root down to the replaced subtree, sharing every untouched sibling.
+template<class Key, class Compare, class Allocator>
+PersistentBinarySearchTree<Key, Compare, Allocator>::node_type* PersistentBinarySearchTree<Key, Compare, Allocator>::copy_path(const NodeStack<node_type>& path, node_type* replacement, const Key& key) {
+    for (size_type i = path.size(); i > 0; --i) {
+        node_type* node = path[i - 1];
+        if (Compare()(node->data_, key)) {
+            replacement = new node_type(node->data_, acquire(node->left_), replacement);
+        } else {
+            replacement = new node_type(node->data_, replacement, acquire(node->right_));
+        }
+    }
+    return replacement;
+}
+
+// A node with two children is replaced by its in-order predecessor, which keeps equal keys on the left.
+template<class Key, class Compare, class Allocator>
+bool PersistentBinarySearchTree<Key, Compare, Allocator>::erase_one(const Key& key) {
+    NodeStack<node_type> path;
+    node_type* node = root_;
+    while (node != nullptr && (Compare()(node->data_, key) || Compare()(key, node->data_))) {
+        path.push(node);
+        node = Compare()(node->data_, key) ? node->right_ : node->left_;
+    }
+    if (node == nullptr) {
+        return false;
+    }
+
+    node_type* replacement;
+    if (node->left_ == nullptr) {
+        replacement = acquire(node->right_);
+    } else if (node->right_ == nullptr) {
+        replacement = acquire(node->left_);
+    } else {
+        NodeStack<node_type> spine;
+        node_type* predecessor = node->left_;
+        while (predecessor->right_ != nullptr) {
+            spine.push(predecessor);
+            predecessor = predecessor->right_;
+        }
+        node_type* left = acquire(predecessor->left_);
+        while (!spine.empty()) {
+            node_type* spine_node = spine.pop();
+            left = new node_type(spine_node->data_, acquire(spine_node->left_), left);
+        }
+        replacement = new node_type(predecessor->data_, left, acquire(node->right_));
+    }
+
+    node_type* root = copy_path(path, replacement, key);
+    release(root_);
+    root_ = root;
+    --size_;
+    return true;
+}
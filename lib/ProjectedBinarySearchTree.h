@@ -0,0 +1,440 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "NodeAlgorithms.h"
+
+// Projection that reads one data member, e.g. project_member<&Order::id>.
+template<auto Member>
+struct project_member {
+    template<class Value>
+    const auto& operator()(const Value& value) const {
+        return value.*Member;
+    }
+};
+
+// Node that keeps only the projected key next to the links; the value it was taken from lives in an
+// allocation of its own and is read once a search has found its node.
+template<typename K, typename V>
+struct ProjectedNode {
+    ProjectedNode(const K& key, V* value, ProjectedNode<K, V>* parent) : key_(key), parent_(parent), value_(value) {}
+
+    K key_;
+    ProjectedNode<K, V>* left_ = nullptr;
+    ProjectedNode<K, V>* right_ = nullptr;
+    ProjectedNode<K, V>* parent_ = nullptr;
+    V* value_;
+};
+
+// Unbalanced binary search tree of large values ordered by Projection()(value). Descents in insert,
+// find and the bounds compare the keys stored inline and never touch a value, so a node of an int key
+// takes 40 bytes however large Value is. Lookups take the projected key; values with equal keys are
+// kept in insertion order reversed, as in BinarySearchTree.
+template<class Value, class Projection, class Compare = std::less<std::remove_cvref_t<std::invoke_result_t<Projection, const Value&>>>, class Allocator = std::allocator<Value>>
+class ProjectedBinarySearchTree {
+public:
+    typedef std::remove_cvref_t<std::invoke_result_t<Projection, const Value&>> key_type;
+    typedef Value value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Projection projection;
+    typedef Allocator allocator_type;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+    typedef ProjectedNode<key_type, Value> node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    ProjectedBinarySearchTree() = default;
+    explicit ProjectedBinarySearchTree(const Allocator& alloc);
+    template<class InputIt>
+    ProjectedBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    ProjectedBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+    ProjectedBinarySearchTree(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other);
+    ProjectedBinarySearchTree(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>&& other) noexcept;
+    ~ProjectedBinarySearchTree();
+
+    ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& operator=(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other);
+    ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& operator=(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>&& other) noexcept;
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] size_type max_size() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    iterator insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<value_type> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const key_type& key);
+    void swap(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(const key_type& key) const;
+    const_iterator find(const key_type& key) const;
+    bool contains(const key_type& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const;
+    const_iterator lower_bound(const key_type& key) const;
+    const_iterator upper_bound(const key_type& key) const;
+
+    key_compare key_comp() const;
+    projection key_projection() const;
+
+    bool operator==(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& rhs) const;
+    bool operator!=(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator> value_traits;
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<node_type> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    typedef NodeAlgorithms<PointerLinks<node_type>> algorithms;
+
+    node_type* root_ = nullptr;
+    size_type size_ = 0;
+    [[no_unique_address]] Allocator value_allocator_;
+    [[no_unique_address]] node_allocator node_allocator_;
+
+    node_type* make_node(const key_type& key, const value_type& value, node_type* parent);
+    void destroy_node(node_type* node);
+};
+
+template<class Value, class Projection, class Compare, class Allocator>
+class ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Value* pointer;
+    typedef const Value& reference;
+
+    const_iterator() = default;
+    const_iterator(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>* tree, node_type* node) : tree_(tree), node_(node) {}
+
+    reference operator*() const { return *node_->value_; }
+    pointer operator->() const { return node_->value_; }
+    // The projected key, read from the node without touching the value.
+    const key_type& key() const { return node_->key_; }
+
+    const_iterator& operator++() {
+        node_ = algorithms::successor({}, node_);
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        node_ = node_ == nullptr ? algorithms::maximum({}, tree_->root_) : algorithms::predecessor({}, node_);
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+    bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    node_type* get_node() const { return node_; }
+
+private:
+    const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>* tree_ = nullptr;
+    node_type* node_ = nullptr;
+};
+
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::ProjectedBinarySearchTree(const Allocator& alloc) : value_allocator_(alloc), node_allocator_(alloc) {}
+
+template<class Value, class Projection, class Compare, class Allocator>
+template<class InputIt>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::ProjectedBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::ProjectedBinarySearchTree(std::initializer_list<value_type> init, const Allocator& alloc) : ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>(init.begin(), init.end(), alloc) {}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::ProjectedBinarySearchTree(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other)
+        : value_allocator_(value_traits::select_on_container_copy_construction(other.value_allocator_)), node_allocator_(value_allocator_) {
+    root_ = algorithms::copy({}, other.root_, [this](node_type* source, node_type* parent) {
+        return make_node(source->key_, *source->value_, parent);
+    });
+    size_ = other.size_;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::ProjectedBinarySearchTree(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>&& other) noexcept
+        : value_allocator_(other.value_allocator_), node_allocator_(other.node_allocator_) {
+    swap(other);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::~ProjectedBinarySearchTree() {
+    clear();
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::operator=(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other) {
+    if (this != &other) {
+        ProjectedBinarySearchTree<Value, Projection, Compare, Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::operator=(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::allocator_type ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::get_allocator() const noexcept {
+    return value_allocator_;
+}
+
+
+// Implementation of iterators
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::begin() const noexcept {
+    return const_iterator(this, algorithms::minimum({}, root_));
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::end() const noexcept {
+    return const_iterator(this, nullptr);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::cbegin() const noexcept {
+    return begin();
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::cend() const noexcept {
+    return end();
+}
+
+
+// Implementation of capacity
+
+template<class Value, class Projection, class Compare, class Allocator>
+bool ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::size_type ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::size() const noexcept {
+    return size_;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::size_type ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::max_size() const noexcept {
+    return node_traits::max_size(node_allocator_);
+}
+
+
+// Implementation of modifiers
+
+template<class Value, class Projection, class Compare, class Allocator>
+void ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::clear() noexcept {
+    algorithms::destroy({}, root_, [this](node_type* node) {
+        destroy_node(node);
+    });
+    root_ = nullptr;
+    size_ = 0;
+}
+
+// The value is projected once; the descent compares only the keys in the nodes.
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::insert(const value_type& value) {
+    const key_type& key = Projection()(value);
+    node_type* parent = nullptr;
+    node_type** slot = &root_;
+    while (*slot != nullptr) {
+        parent = *slot;
+        slot = Compare()(parent->key_, key) ? &parent->right_ : &parent->left_;
+    }
+    *slot = make_node(key, value, parent);
+    ++size_;
+    return iterator(this, *slot);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+template<class InputIt>
+void ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+void ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::erase(const_iterator pos) {
+    node_type* node = pos.get_node();
+    node_type* next = algorithms::successor({}, node);
+    algorithms::unlink({}, root_, node);
+    destroy_node(node);
+    --size_;
+    return iterator(this, next);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+        first = erase(first);
+    }
+    return iterator(this, last.get_node());
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::size_type ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::erase(const key_type& key) {
+    size_type count = 0;
+    const_iterator it = lower_bound(key);
+    while (it != end() && !Compare()(key, it.key())) {
+        it = erase(it);
+        ++count;
+    }
+    return count;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+void ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::swap(ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(value_allocator_, other.value_allocator_);
+    std::swap(node_allocator_, other.node_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::size_type ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::count(const key_type& key) const {
+    size_type count = 0;
+    for (const_iterator it = lower_bound(key); it != end() && !Compare()(key, it.key()); ++it) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::find(const key_type& key) const {
+    // Both comparisons are made up front, so the only branch is the rarely taken exit and the child is
+    // picked without one.
+    node_type* node = root_;
+    while (node != nullptr) {
+        bool right = Compare()(node->key_, key);
+        bool left = Compare()(key, node->key_);
+        if (!(right | left)) {
+            break;
+        }
+        node = right ? node->right_ : node->left_;
+    }
+    return const_iterator(this, node);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+bool ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::contains(const key_type& key) const {
+    return find(key) != end();
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+std::pair<typename ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator, typename ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator> ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::equal_range(const key_type& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::lower_bound(const key_type& key) const {
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool right = Compare()(node->key_, key);
+        result = right ? result : node;
+        node = right ? node->right_ : node->left_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::const_iterator ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::upper_bound(const key_type& key) const {
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool left = Compare()(key, node->key_);
+        result = left ? node : result;
+        node = left ? node->left_ : node->right_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::key_compare ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::key_comp() const {
+    return Compare();
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::projection ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::key_projection() const {
+    return Projection();
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+bool ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::operator==(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& rhs) const {
+    return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+bool ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::operator!=(const ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+template<class Value, class Projection, class Compare, class Allocator>
+ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::node_type* ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::make_node(const key_type& key, const value_type& value, node_type* parent) {
+    Value* stored = value_traits::allocate(value_allocator_, 1);
+    value_traits::construct(value_allocator_, stored, value);
+    node_type* node = node_traits::allocate(node_allocator_, 1);
+    node_traits::construct(node_allocator_, node, key, stored, parent);
+    return node;
+}
+
+template<class Value, class Projection, class Compare, class Allocator>
+void ProjectedBinarySearchTree<Value, Projection, Compare, Allocator>::destroy_node(node_type* node) {
+    value_traits::destroy(value_allocator_, node->value_);
+    value_traits::deallocate(value_allocator_, node->value_, 1);
+    node_traits::destroy(node_allocator_, node);
+    node_traits::deallocate(node_allocator_, node, 1);
+}
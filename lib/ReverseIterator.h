@@ -1,8 +1,9 @@
 #pragma once
 
+#include "Instrumentation.h"
 #include "Node.h"
 
-template<class T, class Traversal = InOrder, class Category = std::bidirectional_iterator_tag, class Distance = std::ptrdiff_t, class Pointer = const T*, class Reference = const T&>
+template<class T, class Traversal = InOrder, class Category = std::bidirectional_iterator_tag, class Distance = std::ptrdiff_t, class Pointer = const T*, class Reference = const T&, class Instrumentation = NoInstrumentation>
 class const_reverse_iterator_ {
 public:
     typedef InOrder traversal_type;
@@ -12,9 +13,10 @@ public:
     typedef const T* pointer;
     typedef const T& reference;
     typedef Node<T> node_type;
+    typedef typename Instrumentation::handle_type instrumentation_handle;
 
     const_reverse_iterator_();
-    explicit const_reverse_iterator_(node_type* node);
+    explicit const_reverse_iterator_(node_type* node, instrumentation_handle instrumentation = instrumentation_handle());
     const_reverse_iterator_(const const_reverse_iterator_& iter);
     ~const_reverse_iterator_();
 
@@ -38,6 +40,7 @@ public:
     node_type* get_node() const;
 private:
     node_type* node;
+    [[no_unique_address]] instrumentation_handle instrumentation_;
 
     const_reverse_iterator_& pre_increment(tag<InOrder>);
     const_reverse_iterator_ post_increment(tag<InOrder>);
@@ -55,71 +58,76 @@ private:
     const_reverse_iterator_ post_decrement(tag<PostOrder>);
 };
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_reverse_iterator_() {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_reverse_iterator_() {
     node = nullptr;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_reverse_iterator_(const_reverse_iterator_::node_type* node) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_reverse_iterator_(const_reverse_iterator_::node_type* node, instrumentation_handle instrumentation) : instrumentation_(instrumentation) {
     this->node = node;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::const_reverse_iterator_(const const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& iter) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::const_reverse_iterator_(const const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& iter) : instrumentation_(iter.instrumentation_) {
     node = iter.get_node();
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::~const_reverse_iterator_() {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::~const_reverse_iterator_() {
     node = nullptr;
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator=(const const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& iter) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator=(const const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& iter) {
     node = iter.get_node();
+    instrumentation_ = iter.instrumentation_;
     return *this;
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-bool const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator==(const const_reverse_iterator_& iter) const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+bool const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator==(const const_reverse_iterator_& iter) const {
     return *this->node->data_ == iter.get_node()->data_;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-bool const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator!=(const const_reverse_iterator_& iter) const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+bool const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator!=(const const_reverse_iterator_& iter) const {
     return *this->node->data_ != iter.get_node()->data_;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator++() {
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator++() {
+    instrumentation_.on_iterator_step();
     return pre_decrement(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator++(int) {
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator++(int) {
+    instrumentation_.on_iterator_step();
     return post_decrement(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator--() {
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator--() {
+    instrumentation_.on_iterator_step();
     return pre_increment(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
 template<class Tr2>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator--(int) {
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator--(int) {
+    instrumentation_.on_iterator_step();
     return post_increment(tag<Tr2>{});
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<InOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<InOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -133,10 +141,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<InOrder>) {
-    const_reverse_iterator_<T, InOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<InOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -150,9 +158,9 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<InOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<InOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -166,10 +174,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<InOrder>) {
-    const_reverse_iterator_<T, InOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<InOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -184,9 +192,9 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
 }
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<PreOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<PreOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -211,10 +219,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<PreOrder>) {
-    const_reverse_iterator_<T, PreOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<PreOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -239,9 +247,9 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<PreOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<PreOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -259,10 +267,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<PreOrder>) {
-    const_reverse_iterator_<T, PreOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<PreOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -282,9 +290,9 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
 
 
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_increment(tag<PostOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_increment(tag<PostOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -302,10 +310,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_increment(tag<PostOrder>) {
-    const_reverse_iterator_<T, PostOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_increment(tag<PostOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -323,9 +331,9 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pre_decrement(tag<PostOrder>) {
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>& const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pre_decrement(tag<PostOrder>) {
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -350,10 +358,10 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>& c
     return *this;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::post_decrement(tag<PostOrder>) {
-    const_reverse_iterator_<T, PostOrder> temp = *this;
-    if (node->is_end_) {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation> const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::post_decrement(tag<PostOrder>) {
+    const_reverse_iterator_ temp = *this;
+    if (node->is_end()) {
         node_type* end_node = node;
         node = node->parent_;
         delete end_node;
@@ -378,17 +386,17 @@ const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference> co
     return temp;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::reference const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator*() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::reference const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator*() const {
     return node->data_;
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::pointer const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::operator->() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::pointer const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::operator->() const {
     return (*this);
 }
 
-template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference>
-const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::node_type* const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference>::get_node() const {
+template<class T, class Traversal, class Category, class Distance, class Pointer, class Reference, class Instrumentation>
+const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::node_type* const_reverse_iterator_<T, Traversal, Category, Distance, Pointer, Reference, Instrumentation>::get_node() const {
     return node;
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+// Layout of a saved tree: SerializationHeader followed by payload_size bytes holding `count` keys in
+// sorted order, each written by key_codec<Key>. Integers are stored in host byte order.
+struct SerializationHeader {
+    static constexpr char kMagic[4] = {'B', 'S', 'T', 'K'};
+    static constexpr std::uint16_t kVersion = 1;
+
+    char magic[4] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3]};
+    std::uint16_t version = kVersion;
+    std::uint16_t key_size = 0;
+    std::uint64_t count = 0;
+    std::uint64_t payload_size = 0;
+};
+
+class ChunkWriter {
+public:
+    explicit ChunkWriter(std::ostream& os) : os_(os) {}
+    ChunkWriter(const ChunkWriter&) = delete;
+    ~ChunkWriter() { flush(); }
+
+    void write(const void* data, std::size_t size) {
+        if (size > kChunkSize - used_) {
+            flush();
+            if (size > kChunkSize) {
+                os_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        std::memcpy(chunk_.get() + used_, data, size);
+        used_ += size;
+    }
+
+    void flush() {
+        os_.write(chunk_.get(), static_cast<std::streamsize>(used_));
+        used_ = 0;
+    }
+
+private:
+    static constexpr std::size_t kChunkSize = 1 << 16;
+
+    std::ostream& os_;
+    std::unique_ptr<char[]> chunk_ = std::unique_ptr<char[]>(new char[kChunkSize]);
+    std::size_t used_ = 0;
+};
+
+class ChunkReader {
+public:
+    ChunkReader(std::istream& is, std::uint64_t limit) : is_(is), remaining_(limit) {}
+    ChunkReader(const ChunkReader&) = delete;
+
+    bool read(void* data, std::size_t size) {
+        char* out = static_cast<char*>(data);
+        while (size > 0) {
+            if (position_ == available_ && !refill()) {
+                return false;
+            }
+            std::size_t step = available_ - position_ < size ? available_ - position_ : size;
+            std::memcpy(out, chunk_.get() + position_, step);
+            position_ += step;
+            out += step;
+            size -= step;
+        }
+        return true;
+    }
+
+    // Payload bytes not read yet, buffered or still in the stream.
+    std::uint64_t remaining() const {
+        return remaining_ + (available_ - position_);
+    }
+
+private:
+    static constexpr std::size_t kChunkSize = 1 << 16;
+
+    std::istream& is_;
+    std::uint64_t remaining_;
+    std::unique_ptr<char[]> chunk_ = std::unique_ptr<char[]>(new char[kChunkSize]);
+    std::size_t position_ = 0;
+    std::size_t available_ = 0;
+
+    bool refill() {
+        std::size_t size = remaining_ < kChunkSize ? static_cast<std::size_t>(remaining_) : kChunkSize;
+        if (size == 0 || !is_.read(chunk_.get(), static_cast<std::streamsize>(size))) {
+            return false;
+        }
+        remaining_ -= size;
+        available_ = size;
+        position_ = 0;
+        return true;
+    }
+};
+
+// Adapts a caller-owned byte range to the stream based save/load.
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    explicit MemoryStreamBuffer(std::span<std::byte> buffer) {
+        char* begin = reinterpret_cast<char*>(buffer.data());
+        setp(begin, begin + buffer.size());
+        setg(begin, begin, begin + buffer.size());
+    }
+
+    std::size_t written() const {
+        return static_cast<std::size_t>(pptr() - pbase());
+    }
+};
+
+// Customization point: specialize for key types that are not trivially copyable.
+// fixed_size is the encoded size of every key, or 0 when it varies; min_size, if present, is the
+// smallest encoded size and bounds the key count load() accepts for a payload. read() must fail rather
+// than allocate more than in.remaining() can back.
+template<class Key>
+struct key_codec {
+    static_assert(std::is_trivially_copyable_v<Key>, "specialize key_codec for keys that are not trivially copyable");
+
+    static constexpr std::uint16_t fixed_size = sizeof(Key);
+    static constexpr std::size_t min_size = sizeof(Key);
+
+    static std::size_t size(const Key&) {
+        return sizeof(Key);
+    }
+    static void write(ChunkWriter& out, const Key& key) {
+        out.write(&key, sizeof(Key));
+    }
+    static bool read(ChunkReader& in, Key& key) {
+        return in.read(&key, sizeof(Key));
+    }
+};
+
+template<class CharT, class Traits, class StringAllocator>
+struct key_codec<std::basic_string<CharT, Traits, StringAllocator>> {
+    typedef std::basic_string<CharT, Traits, StringAllocator> string_type;
+
+    static constexpr std::uint16_t fixed_size = 0;
+    static constexpr std::size_t min_size = sizeof(std::uint32_t);
+
+    static std::size_t size(const string_type& key) {
+        return sizeof(std::uint32_t) + key.size() * sizeof(CharT);
+    }
+    static void write(ChunkWriter& out, const string_type& key) {
+        std::uint32_t length = static_cast<std::uint32_t>(key.size());
+        out.write(&length, sizeof(length));
+        out.write(key.data(), key.size() * sizeof(CharT));
+    }
+    static bool read(ChunkReader& in, string_type& key) {
+        std::uint32_t length;
+        if (!in.read(&length, sizeof(length))) {
+            return false;
+        }
+        if (length > in.remaining() / sizeof(CharT)) {
+            return false;
+        }
+        key.resize(length);
+        return in.read(key.data(), length * sizeof(CharT));
+    }
+};
+
+// Smallest encoded key size: key_codec<Key>::min_size where a codec declares it, otherwise the fixed
+// size or one byte.
+template<class Key>
+constexpr std::size_t min_encoded_size() {
+    if constexpr (requires { key_codec<Key>::min_size; }) {
+        return key_codec<Key>::min_size == 0 ? 1 : key_codec<Key>::min_size;
+    } else {
+        return key_codec<Key>::fixed_size == 0 ? 1 : key_codec<Key>::fixed_size;
+    }
+}
+
+// Bytes left in the stream after its current position, or -1 if it cannot seek.
+inline std::uint64_t stream_bytes_left(std::istream& is) {
+    if (!is) {
+        return 0;
+    }
+    std::istream::pos_type here = is.tellg();
+    if (here == std::istream::pos_type(-1)) {
+        return static_cast<std::uint64_t>(-1);
+    }
+    is.seekg(0, std::ios::end);
+    std::istream::pos_type end = is.tellg();
+    if (!is || end == std::istream::pos_type(-1) || end < here) {
+        is.clear();
+        is.seekg(here);
+        return static_cast<std::uint64_t>(-1);
+    }
+    is.seekg(here);
+    return static_cast<std::uint64_t>(end - here);
+}
@@ -0,0 +1,435 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "BinarySearchTree.h"
+
+// Key space is split into ranges [lower_bound_i, lower_bound_i+1), each range owns a BinarySearchTree
+// guarded by its own lock. Point operations are thread-safe; iterators are not stable against
+// concurrent writers, use for_each for a locked ordered scan.
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class ShardedBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Allocator allocator_type;
+    typedef const value_type& const_reference;
+    typedef BinarySearchTree<Key, InOrder, Compare, Allocator> shard_type;
+    typedef typename shard_type::node_type node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    static constexpr size_type kDefaultMaxShardSize = 1 << 16;
+
+    explicit ShardedBinarySearchTree(size_type max_shard_size = kDefaultMaxShardSize);
+    template<class InputIt>
+    ShardedBinarySearchTree(InputIt first_bound, InputIt last_bound, size_type max_shard_size = kDefaultMaxShardSize);
+    ShardedBinarySearchTree(const ShardedBinarySearchTree& other) = delete;
+    ShardedBinarySearchTree& operator=(const ShardedBinarySearchTree& other) = delete;
+    ~ShardedBinarySearchTree();
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_type size() const;
+    [[nodiscard]] size_type shard_count() const;
+    [[nodiscard]] size_type max_shard_size() const noexcept;
+
+    // Modifiers
+
+    void insert(const value_type& value);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    size_type erase(const Key& key);
+    void clear();
+
+    // Lookup
+
+    bool contains(const Key& key) const;
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+
+    // Iterators
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    template<class F>
+    void for_each(F f) const;
+
+private:
+    struct Shard {
+        explicit Shard(bool has_lower, const Key& lower = Key()) : has_lower_(has_lower), lower_(lower) {}
+
+        bool has_lower_;
+        Key lower_;
+        shard_type tree_;
+        mutable std::shared_mutex mutex_;
+        std::atomic<size_type> version_ = 0;
+    };
+
+    Shard** shards_ = nullptr;
+    size_type shard_count_ = 0;
+    size_type max_shard_size_;
+    // Raised under the exclusive directory lock whenever shards_ changes, so an index read under an
+    // earlier epoch still names the same shard while the epoch is unchanged.
+    size_type epoch_ = 0;
+    mutable std::shared_mutex directory_mutex_;
+
+    size_type route(const Key& key) const;
+    const_iterator first_in_shard(size_type index) const;
+
+    void split(size_type index, size_type epoch);
+    static void insert_balanced(shard_type& tree, const Key* keys, size_type first, size_type last);
+};
+
+template<class Key, class Compare, class Allocator>
+class ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator {
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const ShardedBinarySearchTree* owner, size_type shard, node_type* node) : owner_(owner), shard_(shard), node_(node) {}
+
+    reference operator*() const { return node_->data_; }
+    pointer operator->() const { return &node_->data_; }
+
+    const_iterator& operator++() {
+        node_type* next = next_node<Key>(node_);
+        if (next != nullptr) {
+            node_ = next;
+            return *this;
+        }
+        *this = owner_->first_in_shard(shard_ + 1);
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+    bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    size_type shard() const { return shard_; }
+
+private:
+    const ShardedBinarySearchTree* owner_ = nullptr;
+    size_type shard_ = 0;
+    node_type* node_ = nullptr;
+};
+
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::ShardedBinarySearchTree(size_type max_shard_size) : max_shard_size_(max_shard_size < 2 ? 2 : max_shard_size) {
+    shards_ = new Shard*[1];
+    shards_[0] = new Shard(false);
+    shard_count_ = 1;
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+ShardedBinarySearchTree<Key, Compare, Allocator>::ShardedBinarySearchTree(InputIt first_bound, InputIt last_bound, size_type max_shard_size) : max_shard_size_(max_shard_size < 2 ? 2 : max_shard_size) {
+    size_type bounds = 0;
+    for (InputIt it = first_bound; it != last_bound; ++it) {
+        ++bounds;
+    }
+    shards_ = new Shard*[bounds + 1];
+    shards_[0] = new Shard(false);
+    shard_count_ = 1;
+    for (InputIt it = first_bound; it != last_bound; ++it) {
+        if (Compare()(shards_[shard_count_ - 1]->lower_, *it) || !shards_[shard_count_ - 1]->has_lower_) {
+            shards_[shard_count_++] = new Shard(true, *it);
+        }
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::~ShardedBinarySearchTree() {
+    for (size_type i = 0; i < shard_count_; ++i) {
+        delete shards_[i];
+    }
+    delete[] shards_;
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare, class Allocator>
+bool ShardedBinarySearchTree<Key, Compare, Allocator>::empty() const {
+    return size() == 0;
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::size() const {
+    std::shared_lock directory_lock(directory_mutex_);
+    size_type total = 0;
+    for (size_type i = 0; i < shard_count_; ++i) {
+        std::shared_lock shard_lock(shards_[i]->mutex_);
+        total += shards_[i]->tree_.size();
+    }
+    return total;
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::shard_count() const {
+    std::shared_lock directory_lock(directory_mutex_);
+    return shard_count_;
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::max_shard_size() const noexcept {
+    return max_shard_size_;
+}
+
+
+// Implementation of modifiers
+
+template<class Key, class Compare, class Allocator>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::insert(const value_type& value) {
+    bool hot = false;
+    size_type index;
+    size_type epoch;
+    {
+        std::shared_lock directory_lock(directory_mutex_);
+        index = route(value);
+        epoch = epoch_;
+        Shard* shard = shards_[index];
+        std::unique_lock shard_lock(shard->mutex_);
+        shard->tree_.insert(value);
+        ++shard->version_;
+        hot = shard->tree_.size() > max_shard_size_;
+    }
+    if (hot) {
+        split(index, epoch);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+template<class InputIt>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(*first);
+    }
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::erase(const Key& key) {
+    std::shared_lock directory_lock(directory_mutex_);
+    Shard* shard = shards_[route(key)];
+    std::unique_lock shard_lock(shard->mutex_);
+    size_type erased = shard->tree_.erase(key);
+    if (erased != 0) {
+        ++shard->version_;
+    }
+    return erased;
+}
+
+template<class Key, class Compare, class Allocator>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::clear() {
+    std::unique_lock directory_lock(directory_mutex_);
+    for (size_type i = 0; i < shard_count_; ++i) {
+        std::unique_lock shard_lock(shards_[i]->mutex_);
+        shards_[i]->tree_.clear();
+        ++shards_[i]->version_;
+    }
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare, class Allocator>
+bool ShardedBinarySearchTree<Key, Compare, Allocator>::contains(const Key& key) const {
+    std::shared_lock directory_lock(directory_mutex_);
+    Shard* shard = shards_[route(key)];
+    std::shared_lock shard_lock(shard->mutex_);
+    return shard->tree_.contains(key);
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::count(const Key& key) const {
+    std::shared_lock directory_lock(directory_mutex_);
+    Shard* shard = shards_[route(key)];
+    std::shared_lock shard_lock(shard->mutex_);
+    return shard->tree_.count(key);
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator ShardedBinarySearchTree<Key, Compare, Allocator>::find(const Key& key) const {
+    std::shared_lock directory_lock(directory_mutex_);
+    size_type index = route(key);
+    std::shared_lock shard_lock(shards_[index]->mutex_);
+    node_type* node = shards_[index]->tree_.find(key).get_node();
+    if (node == nullptr) {
+        return end();
+    }
+    return const_iterator(this, index, node);
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator ShardedBinarySearchTree<Key, Compare, Allocator>::lower_bound(const Key& key) const {
+    std::shared_lock directory_lock(directory_mutex_);
+    size_type index = route(key);
+    {
+        std::shared_lock shard_lock(shards_[index]->mutex_);
+        node_type* node = shards_[index]->tree_.lower_bound_node(key);
+        if (node != nullptr) {
+            return const_iterator(this, index, node);
+        }
+    }
+    return first_in_shard(index + 1);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator ShardedBinarySearchTree<Key, Compare, Allocator>::begin() const {
+    std::shared_lock directory_lock(directory_mutex_);
+    return first_in_shard(0);
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator ShardedBinarySearchTree<Key, Compare, Allocator>::end() const {
+    return const_iterator(this, static_cast<size_type>(-1), nullptr);
+}
+
+template<class Key, class Compare, class Allocator>
+template<class F>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::for_each(F f) const {
+    std::shared_lock directory_lock(directory_mutex_);
+    for (size_type i = 0; i < shard_count_; ++i) {
+        std::shared_lock shard_lock(shards_[i]->mutex_);
+        if (shards_[i]->tree_.empty()) {
+            continue;
+        }
+        for (node_type* node = shards_[i]->tree_.begin().get_node(); node != nullptr; node = next_node<Key>(node)) {
+            f(node->data_);
+        }
+    }
+}
+
+
+// Implementation of private functions
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::size_type ShardedBinarySearchTree<Key, Compare, Allocator>::route(const Key& key) const {
+    size_type left = 1;
+    size_type right = shard_count_;
+    while (left < right) {
+        size_type middle = left + (right - left) / 2;
+        if (Compare()(key, shards_[middle]->lower_)) {
+            right = middle;
+        } else {
+            left = middle + 1;
+        }
+    }
+    return left - 1;
+}
+
+template<class Key, class Compare, class Allocator>
+ShardedBinarySearchTree<Key, Compare, Allocator>::const_iterator ShardedBinarySearchTree<Key, Compare, Allocator>::first_in_shard(size_type index) const {
+    for (; index < shard_count_; ++index) {
+        std::shared_lock shard_lock(shards_[index]->mutex_);
+        if (!shards_[index]->tree_.empty()) {
+            return const_iterator(this, index, shards_[index]->tree_.begin().get_node());
+        }
+    }
+    return end();
+}
+
+template<class Key, class Compare, class Allocator>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::insert_balanced(shard_type& tree, const Key* keys, size_type first, size_type last) {
+    if (first >= last) {
+        return;
+    }
+    size_type middle = first + (last - first) / 2;
+    tree.insert(keys[middle]);
+    insert_balanced(tree, keys, first, middle);
+    insert_balanced(tree, keys, middle + 1, last);
+}
+
+// The new halves are built under the shard's shared lock, so readers and writers of other shards
+// keep running; the directory is locked exclusively only to publish them. The split is dropped if
+// the directory changed since `epoch`, in which case `index` may name another shard, or if the shard
+// was written in between; a later insert into a shard still too large tries again.
+template<class Key, class Compare, class Allocator>
+void ShardedBinarySearchTree<Key, Compare, Allocator>::split(size_type index, size_type epoch) {
+    Shard* lower_shard;
+    Shard* upper_shard;
+    size_type version;
+    {
+        std::shared_lock directory_lock(directory_mutex_);
+        if (epoch_ != epoch) {
+            return;
+        }
+        Shard* shard = shards_[index];
+        std::shared_lock shard_lock(shard->mutex_);
+        size_type n = shard->tree_.size();
+        if (n <= max_shard_size_) {
+            return;
+        }
+        version = shard->version_;
+
+        std::unique_ptr<Key[]> keys(new Key[n]);
+        size_type i = 0;
+        for (node_type* node = shard->tree_.begin().get_node(); node != nullptr; node = next_node<Key>(node)) {
+            keys[i++] = node->data_;
+        }
+
+        size_type middle = n / 2;
+        while (middle < n && !Compare()(keys[middle - 1], keys[middle])) {
+            ++middle;
+        }
+        if (middle == n) {
+            middle = n / 2;
+            while (middle > 0 && !Compare()(keys[middle - 1], keys[middle])) {
+                --middle;
+            }
+            if (middle == 0) {
+                return;
+            }
+        }
+
+        lower_shard = new Shard(shard->has_lower_, shard->lower_);
+        upper_shard = new Shard(true, keys[middle]);
+        insert_balanced(lower_shard->tree_, keys.get(), 0, middle);
+        insert_balanced(upper_shard->tree_, keys.get(), middle, n);
+    }
+
+    std::unique_lock directory_lock(directory_mutex_);
+    if (epoch_ != epoch || shards_[index]->version_ != version) {
+        delete lower_shard;
+        delete upper_shard;
+        return;
+    }
+    Shard* shard = shards_[index];
+
+    Shard** shards = new Shard*[shard_count_ + 1];
+    for (size_type i = 0; i < index; ++i) {
+        shards[i] = shards_[i];
+    }
+    shards[index] = lower_shard;
+    shards[index + 1] = upper_shard;
+    for (size_type i = index + 1; i < shard_count_; ++i) {
+        shards[i + 1] = shards_[i];
+    }
+    delete[] shards_;
+    shards_ = shards;
+    ++shard_count_;
+    ++epoch_;
+    delete shard;
+}
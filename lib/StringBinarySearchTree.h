@@ -0,0 +1,578 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "NodeAlgorithms.h"
+
+// Node of a string tree. The first eight bytes of the key, zero-padded and read big-endian, are cached
+// in prefix_, so two keys whose prefixes differ compare like the integers. Keys of up to
+// kInlineCapacity bytes are stored in the node; longer ones live in the tree's arena.
+struct StringNode {
+    static constexpr std::size_t kPrefixBytes = sizeof(std::uint64_t);
+    static constexpr std::size_t kInlineCapacity = 16;
+
+    std::uint64_t prefix_;
+    std::uint32_t length_;
+    union {
+        char inline_[kInlineCapacity];
+        const char* heap_;
+    };
+    StringNode* left_ = nullptr;
+    StringNode* right_ = nullptr;
+    StringNode* parent_ = nullptr;
+
+    const char* data() const { return length_ <= kInlineCapacity ? inline_ : heap_; }
+    std::string_view key() const { return std::string_view(data(), length_); }
+
+    static std::uint64_t prefix_of(std::string_view key) {
+        std::uint64_t prefix = 0;
+        std::memcpy(&prefix, key.data(), std::min(key.size(), kPrefixBytes));
+        if constexpr (std::endian::native == std::endian::little) {
+            prefix = std::byteswap(prefix);
+        }
+        return prefix;
+    }
+};
+
+// Unbalanced binary search tree of std::string keys in lexicographic byte order with the interface of
+// BinarySearchTree. A descent resolves most levels with one integer compare of the cached prefixes and
+// reads the key bytes only on a tie. Long keys are copied into arena chunks. The bytes of erased keys
+// are reclaimed when the tree empties, or when the arena needs a new chunk and they outweigh the live
+// ones. Iterators yield std::string_view; lookups take anything convertible to one. Keys are at most
+// 4 GiB long.
+template<class Allocator = std::allocator<char>>
+class StringBinarySearchTree {
+public:
+    typedef std::string key_type;
+    typedef std::string value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::less<std::string_view> key_compare;
+    typedef std::less<std::string_view> value_compare;
+    typedef Allocator allocator_type;
+    typedef StringNode node_type;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    StringBinarySearchTree() = default;
+    explicit StringBinarySearchTree(const Allocator& alloc);
+    template<class InputIt>
+    StringBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+    StringBinarySearchTree(std::initializer_list<std::string_view> init, const Allocator& alloc = Allocator());
+    StringBinarySearchTree(const StringBinarySearchTree<Allocator>& other);
+    StringBinarySearchTree(StringBinarySearchTree<Allocator>&& other) noexcept;
+    ~StringBinarySearchTree();
+
+    StringBinarySearchTree<Allocator>& operator=(const StringBinarySearchTree<Allocator>& other);
+    StringBinarySearchTree<Allocator>& operator=(StringBinarySearchTree<Allocator>&& other) noexcept;
+
+    allocator_type get_allocator() const noexcept;
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+    [[nodiscard]] size_type max_size() const noexcept;
+    // Bytes held in arena chunks, including those of erased keys not reclaimed yet.
+    [[nodiscard]] size_type arena_bytes() const noexcept;
+
+    // Modifiers
+
+    void clear() noexcept;
+    iterator insert(std::string_view key);
+    template<class InputIt>
+    void insert(InputIt first, InputIt last);
+    void insert(std::initializer_list<std::string_view> ilist);
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(std::string_view key);
+    void swap(StringBinarySearchTree<Allocator>& other) noexcept;
+
+    // Lookup
+
+    size_type count(std::string_view key) const;
+    const_iterator find(std::string_view key) const;
+    bool contains(std::string_view key) const;
+    std::pair<const_iterator, const_iterator> equal_range(std::string_view key) const;
+    const_iterator lower_bound(std::string_view key) const;
+    const_iterator upper_bound(std::string_view key) const;
+
+    key_compare key_comp() const;
+    value_compare value_comp() const;
+
+    bool operator==(const StringBinarySearchTree<Allocator>& rhs) const;
+    bool operator!=(const StringBinarySearchTree<Allocator>& rhs) const;
+
+private:
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<node_type> node_allocator;
+    typedef std::allocator_traits<node_allocator> node_traits;
+    typedef std::allocator_traits<Allocator>::template rebind_alloc<char> char_allocator;
+    typedef std::allocator_traits<char_allocator> char_traits;
+    typedef NodeAlgorithms<PointerLinks<node_type>> algorithms;
+
+    // Arena chunk; the key bytes follow the header.
+    struct Chunk {
+        Chunk* next_;
+        std::size_t capacity_;
+    };
+
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    node_type* root_ = nullptr;
+    size_type size_ = 0;
+    Chunk* chunks_ = nullptr;
+    std::size_t chunk_used_ = 0;
+    size_type arena_bytes_ = 0;
+    // Bytes of the long keys in the tree and of the erased ones still in the arena.
+    size_type live_bytes_ = 0;
+    size_type dead_bytes_ = 0;
+    [[no_unique_address]] node_allocator node_allocator_;
+    [[no_unique_address]] char_allocator char_allocator_;
+
+    // Three-way comparison of a node's key with `key`, whose prefix is given.
+    static int compare(const node_type* node, std::uint64_t prefix, std::string_view key);
+
+    node_type* make_node(std::string_view key, std::uint64_t prefix, node_type* parent);
+    void destroy_node(node_type* node);
+    const char* store(std::string_view key);
+    void release_arena() noexcept;
+    void free_chunks(Chunk* chunk) noexcept;
+};
+
+template<class Allocator>
+class StringBinarySearchTree<Allocator>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef std::string_view value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef std::string_view reference;
+
+    const_iterator() = default;
+    const_iterator(const StringBinarySearchTree<Allocator>* tree, node_type* node) : tree_(tree), node_(node) {}
+
+    reference operator*() const { return node_->key(); }
+
+    const_iterator& operator++() {
+        node_ = algorithms::successor({}, node_);
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+    }
+    const_iterator& operator--() {
+        node_ = node_ == nullptr ? algorithms::maximum({}, tree_->root_) : algorithms::predecessor({}, node_);
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --*this;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+    bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    node_type* get_node() const { return node_; }
+
+private:
+    const StringBinarySearchTree<Allocator>* tree_ = nullptr;
+    node_type* node_ = nullptr;
+};
+
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::StringBinarySearchTree(const Allocator& alloc) : node_allocator_(alloc), char_allocator_(alloc) {}
+
+template<class Allocator>
+template<class InputIt>
+StringBinarySearchTree<Allocator>::StringBinarySearchTree(InputIt first, InputIt last, const Allocator& alloc) : StringBinarySearchTree<Allocator>(alloc) {
+    insert(first, last);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::StringBinarySearchTree(std::initializer_list<std::string_view> init, const Allocator& alloc) : StringBinarySearchTree<Allocator>(init.begin(), init.end(), alloc) {}
+
+// The copy gets a fresh arena holding only the live keys.
+template<class Allocator>
+StringBinarySearchTree<Allocator>::StringBinarySearchTree(const StringBinarySearchTree<Allocator>& other)
+        : node_allocator_(node_traits::select_on_container_copy_construction(other.node_allocator_)), char_allocator_(node_allocator_) {
+    root_ = algorithms::copy({}, other.root_, [this](node_type* source, node_type* parent) {
+        return make_node(source->key(), source->prefix_, parent);
+    });
+    size_ = other.size_;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::StringBinarySearchTree(StringBinarySearchTree<Allocator>&& other) noexcept
+        : node_allocator_(other.node_allocator_), char_allocator_(other.char_allocator_) {
+    swap(other);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::~StringBinarySearchTree() {
+    clear();
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>& StringBinarySearchTree<Allocator>::operator=(const StringBinarySearchTree<Allocator>& other) {
+    if (this != &other) {
+        StringBinarySearchTree<Allocator> copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>& StringBinarySearchTree<Allocator>::operator=(StringBinarySearchTree<Allocator>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::allocator_type StringBinarySearchTree<Allocator>::get_allocator() const noexcept {
+    return allocator_type(node_allocator_);
+}
+
+
+// Implementation of iterators
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::begin() const noexcept {
+    return const_iterator(this, algorithms::minimum({}, root_));
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::end() const noexcept {
+    return const_iterator(this, nullptr);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::cbegin() const noexcept {
+    return begin();
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::cend() const noexcept {
+    return end();
+}
+
+
+// Implementation of capacity
+
+template<class Allocator>
+bool StringBinarySearchTree<Allocator>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::size_type StringBinarySearchTree<Allocator>::size() const noexcept {
+    return size_;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::size_type StringBinarySearchTree<Allocator>::max_size() const noexcept {
+    return node_traits::max_size(node_allocator_);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::size_type StringBinarySearchTree<Allocator>::arena_bytes() const noexcept {
+    return arena_bytes_;
+}
+
+
+// Implementation of modifiers
+
+// Frees the nodes, then the whole arena.
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::clear() noexcept {
+    algorithms::destroy({}, root_, [this](node_type* node) {
+        destroy_node(node);
+    });
+    root_ = nullptr;
+    size_ = 0;
+    release_arena();
+}
+
+// Equal keys are inserted before the existing ones, as in BinarySearchTree.
+template<class Allocator>
+StringBinarySearchTree<Allocator>::iterator StringBinarySearchTree<Allocator>::insert(std::string_view key) {
+    std::uint64_t prefix = node_type::prefix_of(key);
+    node_type* parent = nullptr;
+    node_type** slot = &root_;
+    while (*slot != nullptr) {
+        parent = *slot;
+        slot = compare(parent, prefix, key) < 0 ? &parent->right_ : &parent->left_;
+    }
+    *slot = make_node(key, prefix, parent);
+    ++size_;
+    return iterator(this, *slot);
+}
+
+template<class Allocator>
+template<class InputIt>
+void StringBinarySearchTree<Allocator>::insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+        insert(std::string_view(*first));
+    }
+}
+
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::insert(std::initializer_list<std::string_view> ilist) {
+    insert(ilist.begin(), ilist.end());
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::iterator StringBinarySearchTree<Allocator>::erase(const_iterator pos) {
+    node_type* node = pos.get_node();
+    node_type* next = algorithms::successor({}, node);
+    algorithms::unlink({}, root_, node);
+    destroy_node(node);
+    if (--size_ == 0) {
+        release_arena();
+    }
+    return iterator(this, next);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::iterator StringBinarySearchTree<Allocator>::erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+        first = erase(first);
+    }
+    return iterator(this, last.get_node());
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::size_type StringBinarySearchTree<Allocator>::erase(std::string_view key) {
+    size_type count = 0;
+    const_iterator it = lower_bound(key);
+    while (it != end() && *it == key) {
+        it = erase(it);
+        ++count;
+    }
+    return count;
+}
+
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::swap(StringBinarySearchTree<Allocator>& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(chunks_, other.chunks_);
+    std::swap(chunk_used_, other.chunk_used_);
+    std::swap(arena_bytes_, other.arena_bytes_);
+    std::swap(live_bytes_, other.live_bytes_);
+    std::swap(dead_bytes_, other.dead_bytes_);
+    std::swap(node_allocator_, other.node_allocator_);
+    std::swap(char_allocator_, other.char_allocator_);
+}
+
+
+// Implementation of lookup
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::size_type StringBinarySearchTree<Allocator>::count(std::string_view key) const {
+    size_type count = 0;
+    for (const_iterator it = lower_bound(key); it != end() && *it == key; ++it) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::find(std::string_view key) const {
+    std::uint64_t prefix = node_type::prefix_of(key);
+    node_type* node = root_;
+    while (node != nullptr) {
+        // Decided by the prefixes at almost every level; the child pick stays branch-free.
+        bool right = node->prefix_ < prefix;
+        if (node->prefix_ == prefix) {
+            int order = compare(node, prefix, key);
+            if (order == 0) {
+                break;
+            }
+            right = order < 0;
+        }
+        node = right ? node->right_ : node->left_;
+    }
+    return const_iterator(this, node);
+}
+
+template<class Allocator>
+bool StringBinarySearchTree<Allocator>::contains(std::string_view key) const {
+    return find(key) != end();
+}
+
+template<class Allocator>
+std::pair<typename StringBinarySearchTree<Allocator>::const_iterator, typename StringBinarySearchTree<Allocator>::const_iterator> StringBinarySearchTree<Allocator>::equal_range(std::string_view key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::lower_bound(std::string_view key) const {
+    std::uint64_t prefix = node_type::prefix_of(key);
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool right = compare(node, prefix, key) < 0;
+        result = right ? result : node;
+        node = right ? node->right_ : node->left_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::const_iterator StringBinarySearchTree<Allocator>::upper_bound(std::string_view key) const {
+    std::uint64_t prefix = node_type::prefix_of(key);
+    node_type* result = nullptr;
+    for (node_type* node = root_; node != nullptr;) {
+        bool left = compare(node, prefix, key) > 0;
+        result = left ? node : result;
+        node = left ? node->left_ : node->right_;
+    }
+    return const_iterator(this, result);
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::key_compare StringBinarySearchTree<Allocator>::key_comp() const {
+    return key_compare();
+}
+
+template<class Allocator>
+StringBinarySearchTree<Allocator>::value_compare StringBinarySearchTree<Allocator>::value_comp() const {
+    return value_compare();
+}
+
+template<class Allocator>
+bool StringBinarySearchTree<Allocator>::operator==(const StringBinarySearchTree<Allocator>& rhs) const {
+    return size_ == rhs.size_ && std::equal(begin(), end(), rhs.begin());
+}
+
+template<class Allocator>
+bool StringBinarySearchTree<Allocator>::operator!=(const StringBinarySearchTree<Allocator>& rhs) const {
+    return !(*this == rhs);
+}
+
+
+// Implementation of private functions
+
+// Equal prefixes mean the first min(length, 8) bytes agree and the shorter key, if under eight bytes,
+// is followed by zeros in the longer one; either way the rest decides, then the length.
+template<class Allocator>
+int StringBinarySearchTree<Allocator>::compare(const node_type* node, std::uint64_t prefix, std::string_view key) {
+    if (node->prefix_ != prefix) {
+        return node->prefix_ < prefix ? -1 : 1;
+    }
+    std::size_t common = std::min<std::size_t>(node->length_, key.size());
+    if (common > node_type::kPrefixBytes) {
+        int order = std::memcmp(node->data() + node_type::kPrefixBytes, key.data() + node_type::kPrefixBytes, common - node_type::kPrefixBytes);
+        if (order != 0) {
+            return order;
+        }
+    }
+    return node->length_ < key.size() ? -1 : node->length_ > key.size() ? 1 : 0;
+}
+
+// The key is stored before the node is allocated, so neither allocation leaks if the other throws; bytes
+// stored for a node that never made it are dropped by the next compaction.
+template<class Allocator>
+StringBinarySearchTree<Allocator>::node_type* StringBinarySearchTree<Allocator>::make_node(std::string_view key, std::uint64_t prefix, node_type* parent) {
+    if (key.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("StringBinarySearchTree: key longer than 4 GiB");
+    }
+    const char* heap = key.size() > node_type::kInlineCapacity ? store(key) : nullptr;
+    node_type* node = node_traits::allocate(node_allocator_, 1);
+    node_traits::construct(node_allocator_, node);
+    node->prefix_ = prefix;
+    node->length_ = static_cast<std::uint32_t>(key.size());
+    if (heap == nullptr) {
+        std::memcpy(node->inline_, key.data(), key.size());
+    } else {
+        node->heap_ = heap;
+        live_bytes_ += key.size();
+    }
+    node->parent_ = parent;
+    return node;
+}
+
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::destroy_node(node_type* node) {
+    if (node->length_ > node_type::kInlineCapacity) {
+        live_bytes_ -= node->length_;
+        dead_bytes_ += node->length_;
+    }
+    node_traits::destroy(node_allocator_, node);
+    node_traits::deallocate(node_allocator_, node, 1);
+}
+
+// Bump allocation from the newest chunk; a key that does not fit starts a new chunk of at least
+// kChunkSize bytes, leaving the tail of the old one unused. If erased keys outweigh the live ones by
+// then, the new chunk is sized for all live keys, they move into it and the old chunks are freed.
+// Nodes stay where they are, so iterators stay valid.
+template<class Allocator>
+const char* StringBinarySearchTree<Allocator>::store(std::string_view key) {
+    if (chunks_ == nullptr || chunks_->capacity_ - chunk_used_ < key.size()) {
+        bool compact = dead_bytes_ > live_bytes_;
+        std::size_t capacity = std::max<std::size_t>(kChunkSize, key.size() + (compact ? live_bytes_ : 0));
+        char* memory = char_traits::allocate(char_allocator_, sizeof(Chunk) + capacity);
+        Chunk* chunk = new (memory) Chunk{compact ? nullptr : chunks_, capacity};
+        chunk_used_ = 0;
+        if (compact) {
+            char* bytes = reinterpret_cast<char*>(chunk + 1);
+            for (node_type* node = algorithms::minimum({}, root_); node != nullptr; node = algorithms::successor({}, node)) {
+                if (node->length_ > node_type::kInlineCapacity) {
+                    std::memcpy(bytes + chunk_used_, node->heap_, node->length_);
+                    node->heap_ = bytes + chunk_used_;
+                    chunk_used_ += node->length_;
+                }
+            }
+            free_chunks(chunks_);
+            arena_bytes_ = 0;
+            dead_bytes_ = 0;
+        }
+        chunks_ = chunk;
+        arena_bytes_ += capacity;
+    }
+    char* bytes = reinterpret_cast<char*>(chunks_ + 1) + chunk_used_;
+    std::memcpy(bytes, key.data(), key.size());
+    chunk_used_ += key.size();
+    return bytes;
+}
+
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::release_arena() noexcept {
+    free_chunks(chunks_);
+    chunks_ = nullptr;
+    chunk_used_ = 0;
+    arena_bytes_ = 0;
+    live_bytes_ = 0;
+    dead_bytes_ = 0;
+}
+
+template<class Allocator>
+void StringBinarySearchTree<Allocator>::free_chunks(Chunk* chunk) noexcept {
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next_;
+        char_traits::deallocate(char_allocator_, reinterpret_cast<char*>(chunk), sizeof(Chunk) + chunk->capacity_);
+        chunk = next;
+    }
+}
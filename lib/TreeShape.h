@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+
+// Snapshot of a tree's shape. Depths count edges from the root, heights count nodes on the longest
+// root-to-leaf path, so an empty tree has height 0 and a single node has height 1 and depth 0.
+struct TreeShape {
+    unsigned long long size = 0;
+    unsigned long long height = 0;
+    double average_depth = 0;
+    // depth_histogram[d] is the number of nodes at depth d, for d < height.
+    std::unique_ptr<unsigned long long[]> depth_histogram;
+
+    // Largest difference between the heights of a node's two subtrees.
+    unsigned long long max_height_difference = 0;
+    // Nodes whose subtree heights differ by more than one, i.e. that would violate the AVL condition.
+    unsigned long long unbalanced_nodes = 0;
+    // Largest share of a subtree's weight (size + 1) held by one child of its root, over all inner nodes:
+    // about 0.5 when every split is even and close to 1 when the tree is a chain.
+    double max_subtree_skew = 0;
+
+    unsigned long long max_depth() const {
+        return height == 0 ? 0 : height - 1;
+    }
+
+    // Height relative to the minimal height of a tree of the same size; 1 is perfectly balanced and
+    // a list-shaped tree reaches size / log2(size + 1).
+    double height_ratio() const {
+        return size == 0 ? 1.0 : static_cast<double>(height) / std::ceil(std::log2(static_cast<double>(size) + 1));
+    }
+};
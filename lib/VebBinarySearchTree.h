@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Immutable snapshot returned by BinarySearchTree::freeze(tag<VanEmdeBoas>). The keys form a perfect
+// tree of height H stored in van Emde Boas order: a tree is split at half its height into a top tree
+// and the bottom trees hanging from it, the top tree is laid out first, then every bottom tree, each
+// recursively in the same way. Any subtree of about B keys then occupies one contiguous run, so a
+// lookup touches O(log_B n) cache lines for every block size B.
+//
+// Slots past the n real keys, up to 2^H - 1, hold copies of the largest key; searches resolve to the
+// leftmost match, so they never stop on a copy.
+template<class Key, class Compare = std::less<Key>>
+class VebBinarySearchTree {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef unsigned long long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef const value_type& const_reference;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    VebBinarySearchTree() = default;
+    // Builds the layout in O(n) from `count` keys read in sorted order from `first`.
+    template<class InputIt>
+    VebBinarySearchTree(InputIt first, size_type count);
+
+    // Iterators
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    // Capacity
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] size_type size() const noexcept;
+
+    // Lookup
+
+    size_type count(const Key& key) const;
+    const_iterator find(const Key& key) const;
+    bool contains(const Key& key) const;
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+    const_iterator lower_bound(const Key& key) const;
+    const_iterator upper_bound(const Key& key) const;
+
+    key_compare key_comp() const;
+
+private:
+    static constexpr unsigned kMaxHeight = 64;
+
+    std::unique_ptr<Key[]> keys_;
+    size_type size_ = 0;
+    unsigned height_ = 0;
+    // For a node at depth d, the recursive split that made it the root of a bottom tree: the size of
+    // the top tree above it, the size of each bottom tree and the depth of the top tree's root.
+    size_type top_size_[kMaxHeight] = {};
+    size_type bottom_size_[kMaxHeight] = {};
+    unsigned top_depth_[kMaxHeight] = {};
+
+    void split(unsigned depth, unsigned height);
+    // Position of the node with breadth-first index k at the given depth, given the positions of its ancestors.
+    size_type position(size_type k, unsigned depth, const size_type* ancestors) const;
+    const Key& key_at_rank(size_type rank) const;
+    template<class InputIt>
+    void place(size_type k, unsigned depth, size_type* ancestors, InputIt& it, size_type& rank, Key& largest);
+    // Number of keys that go left of `key`: those that compare less or, when `upper`, not greater.
+    // `bound` receives the slot of the key at that rank, which is meaningless when the rank is size().
+    template<bool Upper>
+    size_type rank_of(const Key& key, size_type& bound) const;
+};
+
+// Iterates by in-order rank; dereferencing walks from the root to the key, which costs O(log n)
+// arithmetic and no memory beyond the keys on the path.
+template<class Key, class Compare>
+class VebBinarySearchTree<Key, Compare>::const_iterator {
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef Key value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Key* pointer;
+    typedef const Key& reference;
+
+    const_iterator() = default;
+    const_iterator(const VebBinarySearchTree<Key, Compare>* tree, size_type rank) : tree_(tree), rank_(rank) {}
+
+    reference operator*() const { return tree_->key_at_rank(rank_); }
+    pointer operator->() const { return &tree_->key_at_rank(rank_); }
+
+    const_iterator& operator++() {
+        ++rank_;
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator temp = *this;
+        ++rank_;
+        return temp;
+    }
+    const_iterator& operator--() {
+        --rank_;
+        return *this;
+    }
+    const_iterator operator--(int) {
+        const_iterator temp = *this;
+        --rank_;
+        return temp;
+    }
+
+    bool operator==(const const_iterator& other) const { return rank_ == other.rank_; }
+    bool operator!=(const const_iterator& other) const { return rank_ != other.rank_; }
+
+    size_type rank() const { return rank_; }
+
+private:
+    const VebBinarySearchTree<Key, Compare>* tree_ = nullptr;
+    size_type rank_ = 0;
+};
+
+
+template<class Key, class Compare>
+template<class InputIt>
+VebBinarySearchTree<Key, Compare>::VebBinarySearchTree(InputIt first, size_type count) : size_(count), height_(std::bit_width(count)) {
+    if (count == 0) {
+        return;
+    }
+    keys_.reset(new Key[(size_type(1) << height_) - 1]);
+    split(0, height_);
+
+    size_type ancestors[kMaxHeight] = {};
+    size_type rank = 0;
+    Key largest{};
+    place(1, 0, ancestors, first, rank, largest);
+}
+
+template<class Key, class Compare>
+void VebBinarySearchTree<Key, Compare>::split(unsigned depth, unsigned height) {
+    if (height <= 1) {
+        return;
+    }
+    unsigned top_height = height / 2;
+    unsigned bottom_height = height - top_height;
+    top_size_[depth + top_height] = (size_type(1) << top_height) - 1;
+    bottom_size_[depth + top_height] = (size_type(1) << bottom_height) - 1;
+    top_depth_[depth + top_height] = depth;
+    split(depth, top_height);
+    split(depth + top_height, bottom_height);
+}
+
+// The top tree of a split is laid out first and the bottom trees follow it in order; the bottom tree
+// holding k is numbered by k's bits below the top tree's root. The tables are zero at depth 0, so the
+// root lands at ancestors[0], which callers set to 0.
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::size_type VebBinarySearchTree<Key, Compare>::position(size_type k, unsigned depth, const size_type* ancestors) const {
+    return ancestors[top_depth_[depth]] + top_size_[depth] + (k & top_size_[depth]) * bottom_size_[depth];
+}
+
+// An in-order walk of the perfect tree meets the slots in key order, so the sorted input is consumed directly.
+template<class Key, class Compare>
+template<class InputIt>
+void VebBinarySearchTree<Key, Compare>::place(size_type k, unsigned depth, size_type* ancestors, InputIt& it, size_type& rank, Key& largest) {
+    if (depth == height_) {
+        return;
+    }
+    ancestors[depth] = position(k, depth, ancestors);
+    place(2 * k, depth + 1, ancestors, it, rank, largest);
+    if (rank < size_) {
+        largest = *it;
+        ++it;
+    }
+    keys_[ancestors[depth]] = largest;
+    ++rank;
+    place(2 * k + 1, depth + 1, ancestors, it, rank, largest);
+}
+
+template<class Key, class Compare>
+const Key& VebBinarySearchTree<Key, Compare>::key_at_rank(size_type rank) const {
+    // Rank r sits at the depth given by the trailing zeros of r + 1, at breadth-first index k.
+    unsigned depth = height_ - 1 - std::countr_zero(rank + 1);
+    size_type k = (size_type(1) << depth) + ((rank + 1) >> (height_ - depth));
+    size_type ancestors[kMaxHeight] = {};
+    for (unsigned d = 0; d <= depth; ++d) {
+        ancestors[d] = position(k >> (depth - d), d, ancestors);
+    }
+    return keys_[ancestors[depth]];
+}
+
+// In a perfect tree the turns of a root-to-leaf descent spell the number of keys left of the probe.
+template<class Key, class Compare>
+template<bool Upper>
+VebBinarySearchTree<Key, Compare>::size_type VebBinarySearchTree<Key, Compare>::rank_of(const Key& key, size_type& bound) const {
+    size_type ancestors[kMaxHeight];
+    ancestors[0] = 0;
+    size_type k = 1;
+    size_type last_left = 0;
+    for (unsigned depth = 0; depth < height_; ++depth) {
+        size_type index = position(k, depth, ancestors);
+        ancestors[depth] = index;
+        bool right = Upper ? !Compare()(key, keys_[index]) : Compare()(keys_[index], key);
+        last_left = right ? last_left : index;
+        k = 2 * k + right;
+    }
+    bound = last_left;
+    return std::min(k - (size_type(1) << height_), size_);
+}
+
+
+// Implementation of iterators
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::const_iterator VebBinarySearchTree<Key, Compare>::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::const_iterator VebBinarySearchTree<Key, Compare>::end() const noexcept {
+    return const_iterator(this, size_);
+}
+
+
+// Implementation of capacity
+
+template<class Key, class Compare>
+bool VebBinarySearchTree<Key, Compare>::empty() const noexcept {
+    return size_ == 0;
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::size_type VebBinarySearchTree<Key, Compare>::size() const noexcept {
+    return size_;
+}
+
+
+// Implementation of lookup
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::size_type VebBinarySearchTree<Key, Compare>::count(const Key& key) const {
+    size_type bound;
+    return rank_of<true>(key, bound) - rank_of<false>(key, bound);
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::const_iterator VebBinarySearchTree<Key, Compare>::find(const Key& key) const {
+    size_type bound;
+    size_type rank = rank_of<false>(key, bound);
+    if (rank != size_ && !Compare()(key, keys_[bound])) {
+        return const_iterator(this, rank);
+    }
+    return end();
+}
+
+template<class Key, class Compare>
+bool VebBinarySearchTree<Key, Compare>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<class Key, class Compare>
+std::pair<typename VebBinarySearchTree<Key, Compare>::const_iterator, typename VebBinarySearchTree<Key, Compare>::const_iterator> VebBinarySearchTree<Key, Compare>::equal_range(const Key& key) const {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::const_iterator VebBinarySearchTree<Key, Compare>::lower_bound(const Key& key) const {
+    size_type bound;
+    return const_iterator(this, rank_of<false>(key, bound));
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::const_iterator VebBinarySearchTree<Key, Compare>::upper_bound(const Key& key) const {
+    size_type bound;
+    return const_iterator(this, rank_of<true>(key, bound));
+}
+
+template<class Key, class Compare>
+VebBinarySearchTree<Key, Compare>::key_compare VebBinarySearchTree<Key, Compare>::key_comp() const {
+    return Compare();
+}
@@ -1,6 +1,14 @@
+#pragma once
+
 struct InOrder{};
 struct PreOrder{};
 struct PostOrder{};
 
+struct Unbalanced{};
+struct Scapegoat{};
+struct Splay{};
+
+struct VanEmdeBoas{};
+
 template<class Traversal>
 struct tag {};
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <sstream>
 
 TEST(BinarySearchTreeTestSuite, CreatingDifferentTypesTest) {
     BinarySearchTree<int> int_bst;
@@ -462,7 +463,7 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 9);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 9);
     --it;
@@ -478,7 +479,7 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 1);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 1);
     BinarySearchTree<int>::iterator it_ = it;
@@ -496,7 +497,7 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 9);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 9);
     it_ = --it;
@@ -512,7 +513,7 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 1);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 1);
     it_ = it++;
@@ -535,9 +536,9 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     ASSERT_EQ(*it, 9);
     it_ = it++;
     ASSERT_EQ(*it_, 9);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 9);
     it_ = it--;
     ASSERT_EQ(*it_, 9);
@@ -559,9 +560,9 @@ TEST(BinarySearchTreeTestSuite, InOrderIteratorTest) {
     ASSERT_EQ(*it, 1);
     it_ = it--;
     ASSERT_EQ(*it_, 1);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 1);
 }
 
@@ -590,7 +591,7 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 9);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 9);
     --it;
@@ -606,7 +607,7 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 5);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 5);
     BinarySearchTree<int, PreOrder>::iterator it_ = it;
@@ -624,7 +625,7 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 9);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 9);
     it_ = --it;
@@ -640,7 +641,7 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 5);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 5);
     it_ = it++;
@@ -663,9 +664,9 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     ASSERT_EQ(*it, 9);
     it_ = it++;
     ASSERT_EQ(*it_, 9);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 9);
     it_ = it--;
     ASSERT_EQ(*it_, 9);
@@ -687,9 +688,9 @@ TEST(BinarySearchTreeTestSuite, PreOrderIteratorTest) {
     ASSERT_EQ(*it, 5);
     it_ = it--;
     ASSERT_EQ(*it_, 5);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 5);
 }
 
@@ -718,7 +719,7 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 5);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 5);
     --it;
@@ -734,7 +735,7 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 1);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 1);
     BinarySearchTree<int, PostOrder>::iterator it_ = it;
@@ -752,7 +753,7 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 5);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 5);
     it_ = --it;
@@ -768,7 +769,7 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 1);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 1);
     it_ = it++;
@@ -791,9 +792,9 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     ASSERT_EQ(*it, 5);
     it_ = it++;
     ASSERT_EQ(*it_, 5);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 5);
     it_ = it--;
     ASSERT_EQ(*it_, 5);
@@ -815,9 +816,9 @@ TEST(BinarySearchTreeTestSuite, PostOrderIteratorTest) {
     ASSERT_EQ(*it, 1);
     it_ = it--;
     ASSERT_EQ(*it_, 1);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 1);
 }
 
@@ -847,7 +848,7 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 9);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 9);
     ++it;
@@ -863,7 +864,7 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 1);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 1);
     BinarySearchTree<int>::reverse_iterator it_ = it;
@@ -881,7 +882,7 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 9);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 9);
     it_ = ++it;
@@ -897,7 +898,7 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 1);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 1);
     it_ = it--;
@@ -920,9 +921,9 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     ASSERT_EQ(*it, 9);
     it_ = it--;
     ASSERT_EQ(*it_, 9);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 9);
     it_ = it++;
     ASSERT_EQ(*it_, 9);
@@ -944,9 +945,9 @@ TEST(BinarySearchTreeTestSuite, ReverseInOrderIteratorTest) {
     ASSERT_EQ(*it, 1);
     it_ = it++;
     ASSERT_EQ(*it_, 1);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 1);
 }
 
@@ -976,7 +977,7 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 9);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 9);
     ++it;
@@ -992,7 +993,7 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 5);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 5);
     BinarySearchTree<int, PreOrder>::reverse_iterator it_ = it;
@@ -1010,7 +1011,7 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 9);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 9);
     it_ = ++it;
@@ -1026,7 +1027,7 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 5);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 5);
     it_ = it--;
@@ -1049,9 +1050,9 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     ASSERT_EQ(*it, 9);
     it_ = it--;
     ASSERT_EQ(*it_, 9);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 9);
     it_ = it++;
     ASSERT_EQ(*it_, 9);
@@ -1073,9 +1074,9 @@ TEST(BinarySearchTreeTestSuite, ReversePreOrderIteratorTest) {
     ASSERT_EQ(*it, 5);
     it_ = it++;
     ASSERT_EQ(*it_, 5);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 5);
 }
 
@@ -1105,7 +1106,7 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     --it;
     ASSERT_EQ(*it, 5);
     --it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     ++it;
     ASSERT_EQ(*it, 5);
     ++it;
@@ -1121,7 +1122,7 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     ++it;
     ASSERT_EQ(*it, 1);
     ++it;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     --it;
     ASSERT_EQ(*it, 1);
     BinarySearchTree<int, PostOrder>::reverse_iterator it_ = it;
@@ -1139,7 +1140,7 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     it_ = --it;
     ASSERT_EQ(*it_, 5);
     it_ = --it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = ++it;
     ASSERT_EQ(*it_, 5);
     it_ = ++it;
@@ -1155,7 +1156,7 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     it_ = ++it;
     ASSERT_EQ(*it_, 1);
     it_ = ++it;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     it_ = --it;
     ASSERT_EQ(*it_, 1);
     it_ = it--;
@@ -1178,9 +1179,9 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     ASSERT_EQ(*it, 5);
     it_ = it--;
     ASSERT_EQ(*it_, 5);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it++;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 5);
     it_ = it++;
     ASSERT_EQ(*it_, 5);
@@ -1202,9 +1203,9 @@ TEST(BinarySearchTreeTestSuite, ReversePostOrderIteratorTest) {
     ASSERT_EQ(*it, 1);
     it_ = it++;
     ASSERT_EQ(*it_, 1);
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it_ = it--;
-    ASSERT_TRUE(it_.get_node()->is_end_);
+    ASSERT_TRUE(it_.get_node()->is_end());
     ASSERT_EQ(*it, 1);
 }
 
@@ -1215,11 +1216,11 @@ TEST(BinarySearchTreeTestSuite, InsertWithReturnIteratorTest) {
     it = bst.insert(5);
     ASSERT_EQ(*it, 5);
     it++;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it--;
     ASSERT_EQ(*it, 5);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.insert(3);
     ASSERT_EQ(*it, 3);
@@ -1228,12 +1229,12 @@ TEST(BinarySearchTreeTestSuite, InsertWithReturnIteratorTest) {
     it--;
     ASSERT_EQ(*it, 3);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.insert(7);
     ASSERT_EQ(*it, 7);
     it++;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it--;
     ASSERT_EQ(*it, 7);
     it--;
@@ -1246,7 +1247,7 @@ TEST(BinarySearchTreeTestSuite, InsertWithReturnIteratorTest) {
     it--;
     ASSERT_EQ(*it, 1);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.insert(4);
     ASSERT_EQ(*it, 4);
@@ -1269,7 +1270,7 @@ TEST(BinarySearchTreeTestSuite, InsertWithReturnIteratorTest) {
     it = bst.insert(9);
     ASSERT_EQ(*it, 9);
     it++;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
     it--;
     ASSERT_EQ(*it, 9);
     it--;
@@ -1305,20 +1306,20 @@ TEST(BinarySearchTreeTestSuite, EraseWithReturnIteratorTest) {
     it = bst.erase(bst.find(1));
     ASSERT_EQ(*it, 4);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.erase(bst.find(4));
     ASSERT_EQ(*it, 6);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.erase(bst.find(6));
     ASSERT_EQ(*it, 9);
     it--;
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 
     it = bst.erase(bst.find(9));
-    ASSERT_TRUE(it.get_node()->is_end_);
+    ASSERT_TRUE(it.get_node()->is_end());
 }
 
 TEST(BinarySearchTreeTestSuite, ClearTest) {
@@ -1373,4 +1374,612 @@ TEST(BinarySearchTreeTestSuite, ExtractTest) {
     ASSERT_FALSE(bst.contains(7));
     ASSERT_EQ(bst.extract(1).data_, 1);
     ASSERT_FALSE(bst.contains(1));
-}
\ No newline at end of file
+}
+
+TEST(BinarySearchTreeTestSuite, InsertBatchTest) {
+    BinarySearchTree<int> bst;
+    bst.insert(50000);
+    bst.insert(25000);
+    bst.insert(75000);
+
+    std::vector<int> batch;
+    for (int i = 0; i < 100000; ++i) {
+        batch.push_back((i * 7919) % 100000);
+    }
+    bst.insert_batch(batch, 4);
+    bst.insert_batch(std::vector<int>{3, 1, 2});
+
+    std::multiset<int> expected(batch.begin(), batch.end());
+    expected.insert({50000, 25000, 75000, 3, 1, 2});
+    ASSERT_EQ(bst.size(), expected.size());
+
+    auto expected_it = expected.begin();
+    auto last = bst.end();
+    for (auto it = bst.begin(); it != last; ++it, ++expected_it) {
+        ASSERT_EQ(*it, *expected_it);
+    }
+    ASSERT_EQ(bst.count(2), 2);
+    ASSERT_TRUE(bst.contains(99999));
+}
+
+TEST(BinarySearchTreeTestSuite, SaveLoadTest) {
+    BinarySearchTree<int> bst{5, 3, 7, 1, 4, 6, 9, 3};
+    std::stringstream stream;
+    bst.save(stream);
+    stream << "tail";
+
+    BinarySearchTree<int> loaded{42};
+    ASSERT_TRUE(loaded.load(stream));
+    ASSERT_EQ(loaded.size(), 8);
+    ASSERT_EQ(std::vector<int>(loaded.begin(), loaded.end()), std::vector<int>({1, 3, 3, 4, 5, 6, 7, 9}));
+    ASSERT_EQ(loaded.count(3), 2);
+    ASSERT_FALSE(loaded.contains(42));
+
+    std::string tail;
+    stream >> tail;
+    ASSERT_EQ(tail, "tail");
+}
+
+TEST(BinarySearchTreeTestSuite, SaveLoadBufferTest) {
+    BinarySearchTree<std::string> bst{"pear", "apple", "fig", "", "banana"};
+    std::vector<std::byte> buffer(bst.serialized_size());
+
+    ASSERT_EQ(bst.save(std::span<std::byte>(buffer.data(), buffer.size() - 1)), 0);
+    ASSERT_EQ(bst.save(buffer), buffer.size());
+
+    BinarySearchTree<std::string> loaded;
+    ASSERT_TRUE(loaded.load(buffer));
+    ASSERT_EQ(std::vector<std::string>(loaded.begin(), loaded.end()), std::vector<std::string>({"", "apple", "banana", "fig", "pear"}));
+
+    buffer[0] = std::byte{'X'};
+    ASSERT_FALSE(loaded.load(buffer));
+    ASSERT_EQ(loaded.size(), 5);
+}
+
+// Corrupt headers and lengths must fail the load instead of allocating what they claim.
+TEST(BinarySearchTreeTestSuite, LoadRejectsCorruptInputTest) {
+    BinarySearchTree<int> ints{3, 1, 2};
+    std::vector<std::byte> buffer(ints.serialized_size());
+    ints.save(buffer);
+    SerializationHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+
+    BinarySearchTree<int> loaded{7};
+    auto load_with = [&](SerializationHeader corrupt, std::size_t size) {
+        std::vector<std::byte> copy(buffer.begin(), buffer.begin() + size);
+        std::memcpy(copy.data(), &corrupt, sizeof(corrupt));
+        return loaded.load(copy);
+    };
+    SerializationHeader corrupt = header;
+    corrupt.count = std::uint64_t(1) << 62;
+    ASSERT_FALSE(load_with(corrupt, buffer.size()));
+    // count * key_size wraps around to payload_size.
+    corrupt.count = (std::uint64_t(1) << 62) + 3;
+    ASSERT_FALSE(load_with(corrupt, buffer.size()));
+    corrupt = header;
+    corrupt.payload_size = std::uint64_t(1) << 40;
+    corrupt.count = corrupt.payload_size / sizeof(int);
+    ASSERT_FALSE(load_with(corrupt, buffer.size()));
+    ASSERT_FALSE(load_with(header, buffer.size() - 1));
+    ASSERT_EQ(std::vector<int>(loaded.begin(), loaded.end()), std::vector<int>({7}));
+    ASSERT_TRUE(load_with(header, buffer.size()));
+    ASSERT_EQ(loaded.size(), 3);
+
+    BinarySearchTree<std::string> strings{"abc", "de"};
+    std::stringstream stream;
+    strings.save(stream);
+    std::string image = stream.str();
+    std::memcpy(&header, image.data(), sizeof(header));
+    header.count = std::uint64_t(1) << 60;
+    std::string huge_count = image;
+    std::memcpy(huge_count.data(), &header, sizeof(header));
+    std::stringstream huge_count_stream(huge_count);
+    BinarySearchTree<std::string> loaded_strings;
+    ASSERT_FALSE(loaded_strings.load(huge_count_stream));
+
+    // The first string claims 4 GiB.
+    std::string huge_length = image;
+    std::uint32_t length = 0xFFFFFFFFu;
+    std::memcpy(huge_length.data() + sizeof(header), &length, sizeof(length));
+    std::stringstream huge_length_stream(huge_length);
+    ASSERT_FALSE(loaded_strings.load(huge_length_stream));
+    ASSERT_TRUE(loaded_strings.empty());
+}
+
+// Equal keys are split at the plain midpoint, so a payload of one repeated key still loads balanced.
+TEST(BinarySearchTreeTestSuite, LoadEqualKeysBalancedTest) {
+    const std::uint64_t n = std::uint64_t(1) << 20;
+    SerializationHeader header;
+    header.key_size = sizeof(int);
+    header.count = n;
+    header.payload_size = n * sizeof(int);
+    std::string image(sizeof(header) + header.payload_size, '\0');
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    BinarySearchTree<int> tree;
+    ASSERT_TRUE(tree.load(std::as_bytes(std::span<const char>(image))));
+    ASSERT_EQ(tree.size(), n);
+    ASSERT_LE(tree.height(), std::bit_width(n));
+    ASSERT_EQ(tree.count(0), n);
+
+    // Without a seekable length the keys are buffered in growing chunks.
+    struct UnseekableBuffer : std::streambuf {
+        explicit UnseekableBuffer(std::string& data) {
+            setg(data.data(), data.data(), data.data() + data.size());
+        }
+    } unseekable(image);
+    std::istream is(&unseekable);
+    BinarySearchTree<int> streamed;
+    ASSERT_TRUE(streamed.load(is));
+    ASSERT_EQ(streamed.size(), n);
+    ASSERT_LE(streamed.height(), std::bit_width(n));
+}
+
+TEST(BinarySearchTreeTestSuite, InstrumentationTest) {
+    static_assert(std::is_empty_v<NoInstrumentation>);
+    static_assert(sizeof(BinarySearchTree<int>::iterator) == sizeof(void*));
+
+    BinarySearchTree<int, InOrder, std::less<int>, std::allocator<int>, CountingInstrumentation> bst{5, 3, 7};
+    InstrumentationStats stats = bst.stats();
+    ASSERT_EQ(stats.allocations, 3);
+    ASSERT_EQ(stats.comparisons, 2);
+    ASSERT_EQ(stats.descents, 3);
+    ASSERT_EQ(stats.node_visits, 2);
+
+    bst.reset_stats();
+    ASSERT_TRUE(bst.contains(7));
+    stats = bst.stats();
+    ASSERT_EQ(stats.descents, 1);
+    ASSERT_EQ(stats.node_visits, 1);
+    ASSERT_EQ(stats.comparisons, 1);
+
+    bst.reset_stats();
+    auto last = bst.end();
+    std::vector<int> keys;
+    for (auto it = bst.begin(); it != last; ++it) {
+        keys.push_back(*it);
+    }
+    ASSERT_EQ(keys, std::vector<int>({3, 5, 7}));
+    ASSERT_EQ(bst.stats().iterator_steps, 3);
+    ASSERT_EQ(bst.stats().comparisons, 0);
+
+    bst.clear();
+    ASSERT_EQ(bst.stats().deallocations, 3);
+    ASSERT_EQ(BinarySearchTree<int>().stats().comparisons, 0);
+}
+
+TEST(BinarySearchTreeTestSuite, ShapeTest) {
+    BinarySearchTree<int> empty;
+    ASSERT_EQ(empty.height(), 0);
+    ASSERT_EQ(empty.shape().size, 0);
+
+    BinarySearchTree<int> bst{8, 4, 12, 2, 6, 10, 14, 1};
+    ASSERT_EQ(bst.height(), 4);
+    ASSERT_EQ(bst.height_estimate(), 4);
+    TreeShape shape = bst.shape();
+    ASSERT_EQ(shape.size, 8);
+    ASSERT_EQ(shape.height, 4);
+    ASSERT_EQ(shape.max_depth(), 3);
+    ASSERT_EQ(shape.depth_histogram[0], 1);
+    ASSERT_EQ(shape.depth_histogram[1], 2);
+    ASSERT_EQ(shape.depth_histogram[2], 4);
+    ASSERT_EQ(shape.depth_histogram[3], 1);
+    ASSERT_DOUBLE_EQ(shape.average_depth, 13.0 / 8);
+    ASSERT_EQ(shape.max_height_difference, 1);
+    ASSERT_EQ(shape.unbalanced_nodes, 0);
+
+    BinarySearchTree<int> chain;
+    for (int i = 0; i < 100; ++i) {
+        chain.insert(i);
+    }
+    shape = chain.shape();
+    ASSERT_EQ(chain.height(), 100);
+    ASSERT_EQ(chain.height_estimate(), 100);
+    ASSERT_EQ(shape.max_height_difference, 99);
+    ASSERT_EQ(shape.unbalanced_nodes, 98);
+    ASSERT_DOUBLE_EQ(shape.max_subtree_skew, 100.0 / 101);
+    ASSERT_GT(shape.height_ratio(), 14);
+
+    chain.erase(99);
+    ASSERT_EQ(chain.height(), 99);
+    ASSERT_EQ(chain.height_estimate(), 100);
+
+    std::vector<int> keys(100000);
+    for (int i = 0; i < 100000; ++i) {
+        keys[i] = (i * 7919) % 100003;
+    }
+    BinarySearchTree<int> batch;
+    batch.insert_batch(keys, 4);
+    ASSERT_EQ(batch.height_estimate(), batch.height());
+}
+
+TEST(BinarySearchTreeTestSuite, RebalanceTest) {
+    BinarySearchTree<int, InOrder, std::less<int>, std::allocator<int>, CountingInstrumentation> bst;
+    for (int i = 0; i < 1000; ++i) {
+        bst.insert(i / 2);
+    }
+    ASSERT_EQ(bst.height(), 501);
+
+    bst.reset_stats();
+    bst.rebalance();
+    ASSERT_EQ(bst.height(), 10);
+    ASSERT_EQ(bst.height_estimate(), 10);
+    ASSERT_EQ(bst.stats().allocations, 0);
+    ASSERT_GT(bst.stats().rotations, 0);
+    ASSERT_EQ(bst.shape().size, 1000);
+
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected.push_back(i / 2);
+    }
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), expected);
+    for (int key = 0; key < 500; ++key) {
+        ASSERT_EQ(bst.count(key), 2);
+        ASSERT_TRUE(bst.contains(key));
+        ASSERT_EQ(*bst.lower_bound(key), key);
+    }
+    ASSERT_EQ(bst.erase(250), 2);
+    ASSERT_FALSE(bst.contains(250));
+
+    BinarySearchTree<int> empty;
+    empty.rebalance();
+    ASSERT_TRUE(empty.empty());
+}
+
+TEST(BinarySearchTreeTestSuite, AutoRebalanceTest) {
+    BinarySearchTree<int> bst;
+    bst.set_rebalance_factor(2);
+    for (int i = 0; i < 10000; ++i) {
+        bst.insert(i);
+        ASSERT_LE(bst.height(), 2 * std::bit_width(bst.size()));
+    }
+    ASSERT_EQ(bst.size(), 10000);
+    ASSERT_EQ(bst.count(5000), 1);
+}
+
+TEST(BinarySearchTreeTestSuite, ScapegoatTest) {
+    typedef BinarySearchTree<int, InOrder, std::less<int>, std::allocator<int>, NoInstrumentation, Scapegoat> scapegoat_tree;
+    static_assert(sizeof(scapegoat_tree::node_type) == sizeof(BinarySearchTree<int>::node_type));
+
+    scapegoat_tree bst;
+    for (int i = 0; i < 10000; ++i) {
+        bst.insert(i);
+        if (i % 100 == 0) {
+            ASSERT_LE(bst.height(), std::log(bst.size()) / std::log(1.5) + 2);
+        }
+    }
+    for (int i = 0; i < 1000; ++i) {
+        bst.insert(i);
+    }
+    ASSERT_LE(bst.height(), std::log(bst.size()) / std::log(1.5) + 2);
+    ASSERT_EQ(bst.size(), 11000);
+    ASSERT_EQ(bst.count(500), 2);
+    ASSERT_EQ(bst.count(5000), 1);
+
+    for (int i = 0; i < 9000; ++i) {
+        ASSERT_EQ(bst.erase(i), i < 1000 ? 2 : 1);
+    }
+    ASSERT_EQ(bst.size(), 1000);
+    ASSERT_LE(bst.height(), std::log(bst.size()) / std::log(1.5) + 2);
+
+    std::vector<int> expected;
+    for (int i = 9000; i < 10000; ++i) {
+        expected.push_back(i);
+    }
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), expected);
+}
+
+TEST(BinarySearchTreeTestSuite, SplayTest) {
+    BinarySearchTree<int, InOrder, std::less<int>, std::allocator<int>, CountingInstrumentation, Splay> bst;
+    for (int i = 0; i < 1000; ++i) {
+        bst.insert((i * 7919) % 1000);
+    }
+    bst.insert(500);
+
+    ASSERT_EQ(*bst.find(123), 123);
+    bst.reset_stats();
+    ASSERT_TRUE(bst.contains(123));
+    ASSERT_EQ(bst.stats().node_visits, 0);
+
+    ASSERT_EQ(*bst.lower_bound(-5), 0);
+    bst.reset_stats();
+    ASSERT_TRUE(bst.contains(0));
+    ASSERT_EQ(bst.stats().node_visits, 0);
+    ASSERT_FALSE(bst.contains(1000));
+
+    std::vector<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected.push_back(i);
+        if (i == 500) {
+            expected.push_back(i);
+        }
+    }
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), expected);
+    ASSERT_EQ(bst.count(500), 2);
+    ASSERT_EQ(bst.erase(500), 2);
+    ASSERT_EQ(bst.size(), 999);
+    ASSERT_EQ(bst.height(), bst.shape().height);
+}
+
+template<class Snapshot, class Freeze>
+void check_snapshot(Freeze freeze) {
+    for (int n : {0, 1, 2, 7, 8, 33, 1000}) {
+        BinarySearchTree<int> bst;
+        std::multiset<int> expected;
+        for (int i = 0; i < n; ++i) {
+            int key = (i * 7919) % (n / 2 + 1) * 2;
+            bst.insert(key);
+            expected.insert(key);
+        }
+        Snapshot frozen = freeze(bst);
+        ASSERT_EQ(frozen.size(), static_cast<unsigned long long>(n));
+        ASSERT_TRUE(std::equal(frozen.begin(), frozen.end(), expected.begin(), expected.end()));
+
+        std::vector<int> backwards;
+        for (auto it = frozen.end(); it != frozen.begin();) {
+            backwards.push_back(*--it);
+        }
+        ASSERT_TRUE(std::equal(backwards.begin(), backwards.end(), expected.rbegin(), expected.rend()));
+
+        for (int key = -1; key <= n + 1; ++key) {
+            ASSERT_EQ(frozen.count(key), expected.count(key));
+            ASSERT_EQ(frozen.contains(key), expected.contains(key));
+            auto lower = frozen.lower_bound(key);
+            auto upper = frozen.upper_bound(key);
+            ASSERT_EQ(lower == frozen.end(), expected.lower_bound(key) == expected.end());
+            ASSERT_EQ(upper == frozen.end(), expected.upper_bound(key) == expected.end());
+            if (lower != frozen.end()) {
+                ASSERT_EQ(*lower, *expected.lower_bound(key));
+            }
+            if (upper != frozen.end()) {
+                ASSERT_EQ(*upper, *expected.upper_bound(key));
+            }
+        }
+    }
+}
+
+TEST(BinarySearchTreeTestSuite, FreezeTest) {
+    check_snapshot<FrozenBinarySearchTree<int>>([](const BinarySearchTree<int>& bst) { return bst.freeze(); });
+}
+
+TEST(BinarySearchTreeTestSuite, FreezeVanEmdeBoasTest) {
+    check_snapshot<VebBinarySearchTree<int>>([](const BinarySearchTree<int>& bst) { return bst.freeze(tag<VanEmdeBoas>{}); });
+
+    // Every slot of the perfect tree is read in order.
+    std::vector<int> keys(255);
+    for (int i = 0; i < 255; ++i) {
+        keys[i] = i;
+    }
+    VebBinarySearchTree<int> veb(keys.begin(), keys.size());
+    ASSERT_TRUE(std::equal(veb.begin(), veb.end(), keys.begin(), keys.end()));
+    ASSERT_EQ(*veb.find(200), 200);
+    ASSERT_EQ(veb.find(255), veb.end());
+}
+
+TEST(BinarySearchTreeTestSuite, CompactTest) {
+    BinarySearchTree<int, InOrder, std::less<int>, std::allocator<int>, CountingInstrumentation> bst;
+    std::multiset<int> expected;
+    for (int i = 0; i < 2000; ++i) {
+        int key = (i * 7919) % 1009;
+        bst.insert(key);
+        expected.insert(key);
+    }
+    for (int key = 0; key < 1009; key += 3) {
+        ASSERT_EQ(bst.erase(key), expected.erase(key));
+    }
+    unsigned long long height = bst.height();
+
+    bst.reset_stats();
+    bst.compact();
+    ASSERT_EQ(bst.stats().allocations, expected.size());
+    ASSERT_EQ(bst.stats().deallocations, expected.size());
+    ASSERT_EQ(bst.size(), expected.size());
+    ASSERT_EQ(bst.height(), height);
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), std::vector<int>(expected.begin(), expected.end()));
+
+    // In-order neighbours are neighbours in memory.
+    const char* previous = nullptr;
+    auto last = bst.end();
+    for (auto it = bst.begin(); it != last; ++it) {
+        const char* address = reinterpret_cast<const char*>(&*it);
+        if (previous != nullptr) {
+            ASSERT_EQ(address - previous, sizeof(Node<int>));
+        }
+        previous = address;
+    }
+
+    bst.compact();
+    for (int key = 0; key < 1009; key += 2) {
+        ASSERT_EQ(bst.erase(key), expected.erase(key));
+        bst.insert(-key);
+        expected.insert(-key);
+    }
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), std::vector<int>(expected.begin(), expected.end()));
+    auto copy = bst;
+    bst.clear();
+    ASSERT_TRUE(bst.empty());
+    bst.compact();
+    ASSERT_EQ(std::vector<int>(copy.begin(), copy.end()), std::vector<int>(expected.begin(), expected.end()));
+}
+
+TEST(BinarySearchTreeTestSuite, ReserveTest) {
+    BinarySearchTree<int> bst;
+    ASSERT_EQ(bst.capacity(), 0);
+    bst.reserve(1000);
+    ASSERT_EQ(bst.capacity(), 1000);
+    bst.reserve(10);
+    ASSERT_EQ(bst.capacity(), 1000);
+
+    std::multiset<int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        int key = (i * 7919) % 1009;
+        bst.insert(key);
+        expected.insert(key);
+    }
+    ASSERT_EQ(bst.capacity(), 1000);
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), std::vector<int>(expected.begin(), expected.end()));
+
+    // Every node came from the reserved block.
+    const char* low = reinterpret_cast<const char*>(&*bst.find(0));
+    const char* high = low;
+    auto last = bst.end();
+    for (auto it = bst.begin(); it != last; ++it) {
+        low = std::min(low, reinterpret_cast<const char*>(&*it));
+        high = std::max(high, reinterpret_cast<const char*>(&*it));
+    }
+    ASSERT_EQ(high - low, 999 * sizeof(Node<int>));
+
+    bst.insert(5000);
+    ASSERT_EQ(bst.capacity(), 1001);
+    bst.clear();
+    ASSERT_EQ(bst.capacity(), 1000);
+    bst.insert({3, 1, 2});
+    ASSERT_EQ(bst.capacity(), 1000);
+    bst.shrink_to_fit();
+    ASSERT_EQ(bst.capacity(), 1000);
+    bst.clear();
+    bst.shrink_to_fit();
+    ASSERT_EQ(bst.capacity(), 0);
+
+    std::vector<int> batch(100000);
+    for (int i = 0; i < 100000; ++i) {
+        batch[i] = (i * 7919) % 100003;
+    }
+    bst.insert_batch(batch, 1);
+    bst.insert_batch(batch, 4);
+    ASSERT_EQ(bst.size(), 200000);
+    ASSERT_EQ(bst.count(batch[5]), 2);
+    bst.clear();
+    ASSERT_EQ(bst.capacity(), 100000);
+
+    // Every parallel batch after the first adds a block, and erase() and extract() find a node's block by
+    // its address.
+    bst.shrink_to_fit();
+    std::vector<int> round_keys(1 << 14);
+    for (int round = 0; round < 8; ++round) {
+        for (int i = 0; i < (1 << 14); ++i) {
+            round_keys[i] = i * 8 + round;
+        }
+        bst.insert_batch(round_keys, 4);
+    }
+    ASSERT_EQ(bst.capacity(), 8 << 14);
+    for (int round = 1; round < 5; ++round) {
+        for (int i = 0; i < (1 << 14); ++i) {
+            ASSERT_EQ(bst.erase(i * 8 + round), 1);
+        }
+    }
+    ASSERT_EQ(bst.extract(6).data_, 6);
+    ASSERT_EQ(bst.capacity(), (8 << 14) - 1);
+    bst.shrink_to_fit();
+    ASSERT_EQ(bst.capacity(), (4 << 14) - 1);
+    ASSERT_EQ(bst.count(8 + 5), 1);
+}
+
+TEST(BinarySearchTreeTestSuite, MemoryUsageTest) {
+    ASSERT_EQ(heap_overhead(24), 8);
+    ASSERT_EQ(heap_overhead(32), 16);
+    ASSERT_EQ(heap_overhead(1), 31);
+
+    BinarySearchTree<int> ints;
+    ASSERT_EQ(ints.memory_usage().total_bytes(), 0);
+    for (int i = 0; i < 100; ++i) {
+        ints.insert(i * 37 % 101);
+    }
+    MemoryUsage usage = ints.memory_usage();
+    ASSERT_EQ(usage.nodes, 100);
+    ASSERT_EQ(usage.node_bytes, 100 * sizeof(Node<int>));
+    ASSERT_EQ(usage.key_heap_bytes, 0);
+    ASSERT_EQ(usage.reserved_bytes, 0);
+    ASSERT_EQ(usage.overhead_bytes, 100 * heap_overhead(sizeof(Node<int>)));
+    ASSERT_EQ(ints.erase(36), 1);
+    ASSERT_EQ(ints.memory_usage().nodes, 99);
+    ints.reserve(200);
+    ASSERT_EQ(ints.memory_usage().reserved_bytes, 101 * sizeof(Node<int>));
+    ints.compact();
+    usage = ints.memory_usage();
+    ASSERT_EQ(usage.reserved_bytes, 0);
+    ASSERT_LT(usage.overhead_bytes, 100);
+    // An extracted node keeps its slot without being in the tree or free.
+    ints.extract(50);
+    usage = ints.memory_usage();
+    ASSERT_EQ(usage.nodes, 98);
+    ASSERT_LT(usage.overhead_bytes, 100);
+
+    std::string long_key(100, 'x');
+    BinarySearchTree<std::string> strings{"a", "b", long_key, long_key + "y"};
+    usage = strings.memory_usage();
+    ASSERT_EQ(usage.nodes, 4);
+    ASSERT_GE(usage.key_heap_bytes, 203);
+    ASSERT_EQ(usage.key_heap_bytes, key_heap_usage<std::string>::bytes(*strings.find(long_key)) + key_heap_usage<std::string>::bytes(*strings.find(long_key + "y")));
+    ASSERT_EQ(key_heap_usage<std::string>::bytes(*strings.find("a")), 0);
+
+    BinarySearchTree<std::string> copy = strings;
+    ASSERT_EQ(copy.memory_usage().key_heap_bytes, usage.key_heap_bytes);
+    strings.erase(long_key);
+    ASSERT_EQ(strings.memory_usage().key_heap_bytes, key_heap_usage<std::string>::bytes(*strings.find(long_key + "y")));
+    strings.compact();
+    ASSERT_EQ(strings.memory_usage().key_heap_bytes, key_heap_usage<std::string>::bytes(*strings.find(long_key + "y")));
+    strings.erase(strings.begin(), strings.end());
+    ASSERT_TRUE(strings.empty());
+    ASSERT_EQ(strings.memory_usage().key_heap_bytes, 0);
+    copy.clear();
+    ASSERT_EQ(copy.memory_usage().total_bytes(), 0);
+}
+
+// Whether the kernel grants huge pages depends on the machine, so only the fallback-independent
+// behaviour is checked.
+TEST(BinarySearchTreeTestSuite, HugePagesTest) {
+    BinarySearchTree<int> bst;
+    ASSERT_FALSE(bst.huge_pages());
+    bst.set_huge_pages();
+    ASSERT_TRUE(bst.huge_pages());
+
+    std::multiset<int> expected;
+    for (int i = 0; i < 100000; ++i) {
+        int key = (i * 7919) % 100003;
+        bst.insert(key);
+        expected.insert(key);
+    }
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()), std::vector<int>(expected.begin(), expected.end()));
+    // Slabs double, so the pool holds less than twice the nodes plus one slab.
+    ASSERT_GE(bst.capacity(), 100000);
+    ASSERT_LT(bst.capacity(), 200000 + kHugePageSize / sizeof(Node<int>));
+    MemoryUsage usage = bst.memory_usage();
+    ASSERT_EQ(usage.nodes, 100000);
+    ASSERT_EQ(usage.node_bytes + usage.reserved_bytes, bst.capacity() * sizeof(Node<int>));
+    unsigned long long mapped = bst.mapped_bytes(PageBacking::Small) + bst.mapped_bytes(PageBacking::Transparent) + bst.mapped_bytes(PageBacking::Explicit);
+    ASSERT_EQ(mapped % kHugePageSize, 0);
+
+    BinarySearchTree<int> copy = bst;
+    ASSERT_TRUE(copy.huge_pages());
+    for (int i = 0; i < 100000; i += 2) {
+        bst.erase((i * 7919) % 100003);
+    }
+    ASSERT_EQ(bst.size(), 50000);
+    bst.compact();
+    ASSERT_EQ(std::vector<int>(bst.begin(), bst.end()).size(), 50000);
+    ASSERT_LT(bst.capacity(), 50000 + kHugePageSize / sizeof(Node<int>));
+
+    bst.set_huge_pages(false);
+    bst.clear();
+    bst.shrink_to_fit();
+    ASSERT_EQ(bst.capacity(), 0);
+    bst.insert(1);
+    ASSERT_EQ(bst.capacity(), 1);
+    ASSERT_EQ(bst.mapped_bytes(PageBacking::Small) + bst.mapped_bytes(PageBacking::Transparent) + bst.mapped_bytes(PageBacking::Explicit), 0);
+}
+
+TEST(BinarySearchTreeTestSuite, NodeLayoutTest) {
+    static_assert(sizeof(void*) != 8 || NodeLayout<int>::kSize == 32);
+    static_assert(sizeof(void*) != 8 || NodeLayout<long long>::kSize == 32);
+
+    Node<int> parent(1, nullptr);
+    Node<int> other(2, nullptr);
+    Node<int> end(&parent);
+    ASSERT_TRUE(end.is_end());
+    ASSERT_EQ(end.parent_, &parent);
+    end.parent_ = &other;
+    ASSERT_TRUE(end.is_end());
+    ASSERT_EQ(end.parent_->data_, 2);
+    ASSERT_FALSE(parent.is_end());
+}
@@ -0,0 +1,122 @@
+#include <lib/BTree.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+template<class T>
+struct CountingAllocator {
+    typedef T value_type;
+
+    CountingAllocator() = default;
+    explicit CountingAllocator(long long* live) : live_(live) {}
+    template<class U>
+    CountingAllocator(const CountingAllocator<U>& other) : live_(other.live_) {}
+
+    T* allocate(std::size_t n) {
+        *live_ += static_cast<long long>(n);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* pointer, std::size_t n) {
+        *live_ -= static_cast<long long>(n);
+        std::allocator<T>().deallocate(pointer, n);
+    }
+
+    bool operator==(const CountingAllocator& other) const { return live_ == other.live_; }
+
+    long long* live_ = nullptr;
+};
+
+}
+
+TEST(BTreeTestSuite, NodeLayoutTest) {
+    static_assert(alignof(BTree<int>::leaf_type) == 64);
+    static_assert(sizeof(BTree<int>::leaf_type) == kBTreeNodeBytes);
+    static_assert(sizeof(BTree<int>::inner_type) <= kBTreeNodeBytes);
+    ASSERT_GE(BTree<int>::leaf_type::kCapacity, 50);
+}
+
+TEST(BTreeTestSuite, EraseIteratorTest) {
+    BTree<int> tree;
+    for (int i = 0; i < 10000; ++i) {
+        tree.insert(i);
+    }
+    ASSERT_GE(tree.height(), 3);
+    int expected = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++expected) {
+        ASSERT_EQ(*it, expected);
+        if (expected % 3 != 0) {
+            it = tree.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ASSERT_EQ(tree.size(), 3334);
+    for (int key : tree) {
+        ASSERT_EQ(key % 3, 0);
+    }
+
+    tree.erase(tree.lower_bound(3000), tree.lower_bound(6000));
+    ASSERT_EQ(tree.size(), 2334);
+    ASSERT_EQ(*tree.lower_bound(3000), 6000);
+
+    tree.erase(tree.begin(), tree.end());
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.height(), 0);
+}
+
+TEST(BTreeTestSuite, CompareAndAllocatorTest) {
+    long long live = 0;
+    {
+        BTree<std::string, std::greater<std::string>, CountingAllocator<std::string>> tree{CountingAllocator<std::string>(&live)};
+        for (int i = 0; i < 1000; ++i) {
+            tree.insert(std::to_string(i % 100));
+        }
+        ASSERT_GT(live, 0);
+        ASSERT_EQ(*tree.begin(), "99");
+        ASSERT_EQ(tree.count("42"), 10);
+
+        auto copy = tree;
+        ASSERT_EQ(copy, tree);
+        copy.erase("42");
+        ASSERT_NE(copy, tree);
+
+        auto moved = std::move(copy);
+        ASSERT_TRUE(copy.empty());
+        ASSERT_EQ(moved.size(), 990);
+    }
+    ASSERT_EQ(live, 0);
+}
+
+template<class Key>
+void check_key_search() {
+    static_assert(simd_searchable_key<Key>);
+    typedef key_search<Key, std::less<Key>> search;
+    Key keys[61];
+    for (unsigned count = 0; count <= 61; ++count) {
+        for (unsigned i = 0; i < count; ++i) {
+            keys[i] = static_cast<Key>(i / 3) - static_cast<Key>(5);
+        }
+        for (int probe = -8; probe < 25; ++probe) {
+            Key key = static_cast<Key>(probe);
+            ASSERT_EQ(search::lower_index(keys, count, key), static_cast<unsigned>(std::lower_bound(keys, keys + count, key) - keys));
+            ASSERT_EQ(search::upper_index(keys, count, key), static_cast<unsigned>(std::upper_bound(keys, keys + count, key) - keys));
+        }
+    }
+}
+
+TEST(BTreeTestSuite, KeySearchTest) {
+    check_key_search<std::int32_t>();
+    check_key_search<std::int64_t>();
+    check_key_search<float>();
+    static_assert(!simd_searchable_key<std::uint32_t>);
+    static_assert(!simd_searchable_key<std::string>);
+
+    std::int64_t extremes[] = {std::numeric_limits<std::int64_t>::min(), -1, 0, std::numeric_limits<std::int64_t>::max()};
+    typedef key_search<std::int64_t, std::less<std::int64_t>> search;
+    ASSERT_EQ(search::lower_index(extremes, 4, 0), 2);
+    ASSERT_EQ(search::upper_index(extremes, 4, std::numeric_limits<std::int64_t>::max()), 4);
+}
@@ -0,0 +1,90 @@
+#include <lib/CompactBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(CompactBinarySearchTreeTestSuite, NodeSizeTest) {
+    static_assert(sizeof(CompactBinarySearchTree<int>::node_type) == 16);
+    static_assert(sizeof(CompactBinarySearchTree<std::int64_t>::node_type) == 24);
+}
+
+TEST(CompactBinarySearchTreeTestSuite, IteratorsSurviveInsertTest) {
+    CompactBinarySearchTree<std::string> tree = {"m", "c", "x"};
+    auto it = tree.find("c");
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(std::to_string(i));
+    }
+    ASSERT_EQ(*it, "c");
+    ASSERT_EQ(*++it, "m");
+
+    it = tree.erase(tree.find("m"));
+    ASSERT_EQ(*it, "x");
+    ASSERT_EQ(tree.size(), 1002);
+
+    tree.erase(tree.begin(), tree.find("c"));
+    ASSERT_EQ(*tree.begin(), "c");
+    ASSERT_EQ(tree.size(), 2);
+}
+
+TEST(CompactBinarySearchTreeTestSuite, TraversalTest) {
+    std::initializer_list<int> keys = {5, 3, 8, 1, 4, 7, 9, 2, 6};
+
+    CompactBinarySearchTree<int> in_order = keys;
+    ASSERT_EQ(std::vector<int>(in_order.rbegin(), in_order.rend()), std::vector<int>({9, 8, 7, 6, 5, 4, 3, 2, 1}));
+    ASSERT_EQ(*in_order.crbegin(), 9);
+
+    CompactBinarySearchTree<int, PreOrder> pre_order = keys;
+    ASSERT_EQ(std::vector<int>(pre_order.begin(), pre_order.end()), std::vector<int>({5, 3, 1, 2, 4, 8, 7, 6, 9}));
+    ASSERT_EQ(std::vector<int>(pre_order.rbegin(), pre_order.rend()), std::vector<int>({9, 6, 7, 8, 4, 2, 1, 3, 5}));
+
+    CompactBinarySearchTree<int, PostOrder> post_order = keys;
+    ASSERT_EQ(std::vector<int>(post_order.begin(), post_order.end()), std::vector<int>({2, 1, 4, 3, 6, 7, 9, 8, 5}));
+    ASSERT_EQ(std::vector<int>(post_order.rbegin(), post_order.rend()), std::vector<int>({5, 8, 9, 7, 6, 3, 4, 1, 2}));
+
+    // Lookups and erase(key) go by key order whatever the traversal.
+    ASSERT_EQ(post_order.count(4), 1);
+    ASSERT_EQ(post_order.erase(3), 1);
+    ASSERT_EQ(post_order.size(), 8);
+    CompactBinarySearchTree<int, PostOrder> expected = {1, 2, 4, 5, 6, 7, 8, 9};
+    ASSERT_EQ(post_order, expected);
+}
+
+namespace {
+
+struct ThrowingKey {
+    static inline bool throw_on_copy = false;
+
+    int value;
+
+    ThrowingKey(int value) : value(value) {}
+    ThrowingKey(const ThrowingKey& other) : value(other.value) {
+        if (throw_on_copy) {
+            throw std::runtime_error("copy");
+        }
+    }
+    ThrowingKey& operator=(const ThrowingKey&) = default;
+
+    bool operator<(const ThrowingKey& other) const { return value < other.value; }
+    bool operator==(const ThrowingKey& other) const { return value == other.value; }
+};
+
+}
+
+TEST(CompactBinarySearchTreeTestSuite, ThrowingCopyTest) {
+    CompactBinarySearchTree<ThrowingKey> tree = {2, 1, 3};
+    tree.erase(ThrowingKey(1));
+
+    // Once with a slot on the free list, once with a fresh one.
+    for (int i = 0; i < 2; ++i) {
+        ThrowingKey::throw_on_copy = true;
+        ASSERT_THROW(tree.insert(ThrowingKey(10 + i)), std::runtime_error);
+        ThrowingKey::throw_on_copy = false;
+        ASSERT_EQ(tree.size(), 2 + i);
+        ASSERT_FALSE(tree.contains(ThrowingKey(10 + i)));
+        tree.insert(ThrowingKey(4 + i));
+    }
+    CompactBinarySearchTree<ThrowingKey> expected = {2, 3, 4, 5};
+    ASSERT_EQ(tree, expected);
+}
@@ -0,0 +1,130 @@
+#include <lib/BinarySearchTree.h>
+#include <lib/MappedBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(MappedBinarySearchTreeTestSuite, LookupInMemoryImageTest) {
+    BinarySearchTree<int> bst {5, 3, 7, 3, 1, 3, 9, 8};
+    std::ostringstream os;
+    bst.save_mapped(os);
+    std::string bytes = os.str();
+    std::vector<std::uint64_t> image((bytes.size() + 7) / 8);
+    std::memcpy(image.data(), bytes.data(), bytes.size());
+
+    MappedBinarySearchTree<int> tree(std::as_bytes(std::span(image)).first(bytes.size()));
+
+    ASSERT_TRUE(tree.is_open());
+    ASSERT_EQ(tree.size(), 8);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 3, 3, 3, 5, 7, 8, 9}));
+    ASSERT_EQ(tree.count(3), 3);
+    ASSERT_EQ(*tree.lower_bound(4), 5);
+    ASSERT_EQ(*tree.upper_bound(3), 5);
+    ASSERT_TRUE(tree.upper_bound(9) == tree.end());
+    ASSERT_TRUE(tree.find(6) == tree.end());
+    ASSERT_TRUE(tree.contains(8));
+
+    image[0] = 0;
+    MappedBinarySearchTree<int> corrupted(std::as_bytes(std::span(image)).first(bytes.size()));
+    ASSERT_FALSE(corrupted.is_open());
+    MappedBinarySearchTree<long long> wrong_key(std::as_bytes(std::span(image)).first(bytes.size()));
+    ASSERT_FALSE(wrong_key.is_open());
+}
+
+TEST(MappedBinarySearchTreeTestSuite, MappedFileTest) {
+    BinarySearchTree<std::uint64_t> bst;
+    std::vector<std::uint64_t> expected;
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        std::uint64_t key = (i * 7919) % 10007;
+        bst.insert(key);
+        expected.push_back(key);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "mapped_binary_search_tree_test.bin";
+    {
+        std::ofstream os(path, std::ios::binary);
+        bst.save_mapped(os);
+        ASSERT_TRUE(os.good());
+    }
+
+    {
+        MappedBinarySearchTree<std::uint64_t> tree(path.c_str());
+        ASSERT_TRUE(tree.is_open());
+        ASSERT_EQ(std::vector<std::uint64_t>(tree.begin(), tree.end()), expected);
+        for (std::uint64_t key = 0; key < 10007; key += 13) {
+            auto it = std::lower_bound(expected.begin(), expected.end(), key);
+            ASSERT_EQ(tree.lower_bound(key) == tree.end(), it == expected.end());
+            if (it != expected.end()) {
+                ASSERT_EQ(*tree.lower_bound(key), *it);
+            }
+            ASSERT_EQ(tree.contains(key), std::binary_search(expected.begin(), expected.end(), key));
+        }
+    }
+    std::filesystem::remove(path);
+
+    MappedBinarySearchTree<std::uint64_t> missing(path.c_str());
+    ASSERT_FALSE(missing.is_open());
+    ASSERT_TRUE(missing.empty());
+}
+
+TEST(MappedBinarySearchTreeTestSuite, EqualKeysBalancedTest) {
+    const std::uint64_t n = std::uint64_t(1) << 20;
+    SerializationHeader header;
+    header.key_size = sizeof(int);
+    header.count = n;
+    header.payload_size = n * sizeof(int);
+    std::string payload(sizeof(header) + header.payload_size, '\0');
+    std::memcpy(payload.data(), &header, sizeof(header));
+    BinarySearchTree<int> bst;
+    ASSERT_TRUE(bst.load(std::as_bytes(std::span<const char>(payload))));
+
+    std::ostringstream os;
+    bst.save_mapped(os);
+    std::string bytes = os.str();
+    std::vector<std::uint64_t> image((bytes.size() + 7) / 8);
+    std::memcpy(image.data(), bytes.data(), bytes.size());
+    MappedTreeHeader mapped_header;
+    std::memcpy(&mapped_header, image.data(), sizeof(mapped_header));
+    ASSERT_EQ(mapped_header.root, n / 2);
+
+    MappedBinarySearchTree<int> tree(std::as_bytes(std::span(image)).first(bytes.size()));
+    ASSERT_TRUE(tree.is_open());
+    ASSERT_EQ(tree.count(0), n);
+    ASSERT_TRUE(tree.lower_bound(0) == tree.begin());
+    ASSERT_TRUE(tree.upper_bound(0) == tree.end());
+}
+
+TEST(MappedBinarySearchTreeTestSuite, CorruptOffsetsTest) {
+    BinarySearchTree<int> bst {1, 2, 3, 4, 5, 6, 7};
+    std::ostringstream os;
+    bst.save_mapped(os);
+    std::string bytes = os.str();
+    std::vector<std::uint64_t> image((bytes.size() + 7) / 8);
+    std::memcpy(image.data(), bytes.data(), bytes.size());
+    MappedTreeHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    auto* nodes = reinterpret_cast<MappedNode<int>*>(reinterpret_cast<std::byte*>(image.data()) + header.nodes_offset);
+
+    // Out of the image on both sides, and a right child of the root's left child pointing back at the root.
+    nodes[header.root].left_ = -1000000;
+    nodes[header.root].right_ = 1000000;
+    MappedBinarySearchTree<int> outside(std::as_bytes(std::span(image)).first(bytes.size()));
+    ASSERT_TRUE(outside.is_open());
+    ASSERT_EQ(*outside.lower_bound(0), 4);
+    ASSERT_TRUE(outside.upper_bound(9) == outside.end());
+
+    nodes[header.root].left_ = -2;
+    nodes[header.root].right_ = 2;
+    nodes[header.root - 2].right_ = 2;
+    MappedBinarySearchTree<int> cycle(std::as_bytes(std::span(image)).first(bytes.size()));
+    ASSERT_TRUE(cycle.contains(4));
+    ASSERT_FALSE(cycle.contains(3));
+    ASSERT_TRUE(cycle.contains(2));
+}
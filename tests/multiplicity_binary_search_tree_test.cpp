@@ -0,0 +1,61 @@
+#include <lib/MultiplicityBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <vector>
+
+TEST(MultiplicityBinarySearchTreeTestSuite, BasicOperationsTest) {
+    MultiplicityBinarySearchTree<int> tree = {5, 3, 8, 3, 1, 3, 8};
+    ASSERT_EQ(tree.size(), 7);
+    ASSERT_EQ(tree.distinct_size(), 4);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 3, 3, 3, 5, 8, 8}));
+    ASSERT_EQ(tree.count(3), 3);
+    ASSERT_EQ(tree.count(4), 0);
+    ASSERT_EQ(tree.find(3).multiplicity(), 3);
+    ASSERT_EQ(*tree.lower_bound(4), 5);
+    ASSERT_EQ(*tree.upper_bound(3), 5);
+    ASSERT_EQ(std::distance(tree.equal_range(3).first, tree.equal_range(3).second), 3);
+    ASSERT_EQ(*--tree.end(), 8);
+    ASSERT_EQ(std::vector<int>(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin())), std::vector<int>({8, 8, 5, 3, 3, 3, 1}));
+
+    tree.insert_copies(5, 4);
+    ASSERT_EQ(tree.count(5), 5);
+    ASSERT_EQ(tree.size(), 11);
+    ASSERT_EQ(tree.distinct_size(), 4);
+
+    // Erasing the middle copy leaves the iterator on the next copy of the same key.
+    auto it = tree.erase(std::next(tree.find(3)));
+    ASSERT_EQ(*it, 3);
+    ASSERT_EQ(tree.count(3), 2);
+    it = tree.erase(it);
+    ASSERT_EQ(*it, 5);
+    ASSERT_EQ(tree.count(3), 1);
+
+    ASSERT_EQ(tree.erase(5), 5);
+    ASSERT_EQ(tree.erase(5), 0);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 3, 8, 8}));
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.distinct_size(), 0);
+    ASSERT_EQ(tree.begin(), tree.end());
+}
+
+TEST(MultiplicityBinarySearchTreeTestSuite, EraseRangeTest) {
+    MultiplicityBinarySearchTree<int> tree;
+    tree.insert_copies(1, 3);
+    tree.insert_copies(2, 2);
+    tree.insert_copies(3, 4);
+
+    // Both ends inside one key's copies.
+    auto it = tree.erase(std::next(tree.find(3)), std::next(tree.find(3), 3));
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 1, 1, 2, 2, 3, 3}));
+    ASSERT_EQ(*it, 3);
+    ASSERT_EQ(it, std::next(tree.find(3)));
+
+    // From the second copy of 1 to the second copy of 3.
+    it = tree.erase(std::next(tree.begin()), std::next(tree.find(3)));
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 3}));
+    ASSERT_EQ(*it, 3);
+    ASSERT_EQ(tree.distinct_size(), 2);
+    ASSERT_EQ(tree.erase(tree.begin(), tree.end()), tree.end());
+    ASSERT_TRUE(tree.empty());
+}
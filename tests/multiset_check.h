@@ -0,0 +1,68 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <set>
+
+// Linear congruential generator for the randomized tests; a fixed seed replays the same keys.
+class TestRandom {
+public:
+    explicit TestRandom(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+        return state_ >> 33;
+    }
+    int next(int bound) { return static_cast<int>(next() % bound); }
+
+private:
+    std::uint64_t state_;
+};
+
+struct SameKey {
+    template<class T>
+    const T& operator()(const T& value) const { return value; }
+};
+
+// One round of the differential check against std::multiset: `inserts` random inserts, then `lookups`
+// random keys checked with count, lower_bound and upper_bound and erased, alternately all copies with
+// erase(key) and one copy with erase(find(key)). The tree must then hold what `expected` holds, in both
+// directions. draw() makes a key, make_value turns it into what the tree stores and key_of reads the key
+// back from an element. Call it under ASSERT_NO_FATAL_FAILURE.
+template<class Tree, class Key, class Draw, class MakeValue = SameKey, class KeyOf = SameKey>
+void check_against_multiset(Tree& tree, std::multiset<Key>& expected, Draw draw, int inserts, int lookups, MakeValue make_value = {}, KeyOf key_of = {}) {
+    for (int i = 0; i < inserts; ++i) {
+        Key key = draw();
+        tree.insert(make_value(key));
+        expected.insert(key);
+    }
+    for (int i = 0; i < lookups; ++i) {
+        Key key = draw();
+        ASSERT_EQ(tree.count(key), expected.count(key));
+        auto lower = tree.lower_bound(key);
+        auto expected_lower = expected.lower_bound(key);
+        ASSERT_EQ(lower == tree.end(), expected_lower == expected.end());
+        if (expected_lower != expected.end()) {
+            ASSERT_EQ(key_of(*lower), *expected_lower);
+        }
+        auto upper = tree.upper_bound(key);
+        auto expected_upper = expected.upper_bound(key);
+        ASSERT_EQ(upper == tree.end(), expected_upper == expected.end());
+        if (expected_upper != expected.end()) {
+            ASSERT_EQ(key_of(*upper), *expected_upper);
+        }
+        if (i % 2 == 0) {
+            ASSERT_EQ(tree.erase(key), expected.erase(key));
+        } else if (expected.contains(key)) {
+            tree.erase(tree.find(key));
+            expected.erase(expected.find(key));
+        }
+    }
+
+    auto same = [&key_of](const auto& element, const Key& key) { return key_of(element) == key; };
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end(), same));
+    ASSERT_TRUE(std::equal(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin()), expected.rbegin(), expected.rend(), same));
+}
@@ -0,0 +1,52 @@
+#include <lib/BinarySearchTree.h>
+#include <lib/ParentFreeBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+#include "multiset_check.h"
+
+TEST(ParentFreeBinarySearchTreeTestSuite, NodeSizeTest) {
+    static_assert(sizeof(void*) != 8 || sizeof(ParentFreeBinarySearchTree<int>::node_type) == 24);
+    static_assert(sizeof(ParentFreeBinarySearchTree<int>::node_type) + sizeof(void*) == sizeof(Node<int>));
+}
+
+TEST(ParentFreeBinarySearchTreeTestSuite, EraseIteratorTest) {
+    ParentFreeBinarySearchTree<int> tree;
+    TestRandom random(7);
+    for (int i = 0; i < 10000; ++i) {
+        tree.insert(random.next(10000));
+    }
+    std::multiset<int> expected(tree.begin(), tree.end());
+    auto expected_it = expected.begin();
+    for (auto it = tree.begin(); it != tree.end();) {
+        ASSERT_EQ(*it, *expected_it);
+        if (*it % 3 != 0) {
+            it = tree.erase(it);
+            expected_it = expected.erase(expected_it);
+        } else {
+            ++it;
+            ++expected_it;
+        }
+    }
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+
+    tree.erase(tree.lower_bound(3000), tree.lower_bound(6000));
+    expected.erase(expected.lower_bound(3000), expected.lower_bound(6000));
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+}
+
+TEST(ParentFreeBinarySearchTreeTestSuite, ForEachTest) {
+    ParentFreeBinarySearchTree<int> tree = {5, 3, 8, 3, 1, 9, 7, 2};
+    std::vector<int> visited;
+    tree.for_each([&visited](int key) { visited.push_back(key); });
+    ASSERT_EQ(visited, std::vector<int>({1, 2, 3, 3, 5, 7, 8, 9}));
+    // The threads are all removed again.
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), visited);
+    auto copy = tree;
+    ASSERT_EQ(copy, tree);
+
+    ParentFreeBinarySearchTree<int> empty;
+    empty.for_each([](int) { FAIL(); });
+}
@@ -0,0 +1,64 @@
+#include <lib/PersistentBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(PersistentBinarySearchTreeTestSuite, SnapshotIsolationTest) {
+    PersistentBinarySearchTree<int> tree {5, 3, 7, 1, 4, 6, 9};
+    PersistentBinarySearchTree<int> snapshot = tree.snapshot();
+
+    tree.insert(8);
+    tree.erase(5);
+    tree.erase(1);
+
+    ASSERT_EQ(std::vector<int>(snapshot.begin(), snapshot.end()), std::vector<int>({1, 3, 4, 5, 6, 7, 9}));
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({3, 4, 6, 7, 8, 9}));
+    ASSERT_EQ(snapshot.size(), 7);
+    ASSERT_EQ(tree.size(), 6);
+    ASSERT_TRUE(snapshot.contains(5));
+    ASSERT_FALSE(tree.contains(5));
+}
+
+TEST(PersistentBinarySearchTreeTestSuite, LookupTest) {
+    PersistentBinarySearchTree<int> tree {5, 3, 7, 3, 1, 3, 9};
+
+    ASSERT_EQ(tree.count(3), 3);
+    ASSERT_EQ(*tree.find(7), 7);
+    ASSERT_TRUE(tree.find(8) == tree.end());
+    ASSERT_EQ(*tree.lower_bound(4), 5);
+    ASSERT_EQ(*tree.lower_bound(3), 3);
+    ASSERT_EQ(*tree.upper_bound(3), 5);
+    ASSERT_TRUE(tree.upper_bound(9) == tree.end());
+
+    ASSERT_EQ(tree.erase(3), 3);
+    ASSERT_EQ(tree.count(3), 0);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 5, 7, 9}));
+}
+
+TEST(PersistentBinarySearchTreeTestSuite, ConcurrentReadersTest) {
+    PersistentBinarySearchTree<int> tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert((i * 37) % 1000);
+    }
+    std::multiset<int> expected(tree.begin(), tree.end());
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([snapshot = tree.snapshot(), &expected] {
+            for (int round = 0; round < 20; ++round) {
+                ASSERT_TRUE(std::equal(snapshot.begin(), snapshot.end(), expected.begin(), expected.end()));
+            }
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        tree.erase((i * 37) % 1000);
+        tree.insert(i + 1000);
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQ(tree.size(), 1000);
+    ASSERT_EQ(*tree.begin(), 1000);
+}
@@ -0,0 +1,106 @@
+#include <lib/ProjectedBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "multiset_check.h"
+
+namespace {
+
+struct Record {
+    int id;
+    char payload[252];
+    std::string name;
+
+    bool operator==(const Record& other) const {
+        return id == other.id && name == other.name;
+    }
+};
+
+Record make_record(int id, std::string name = "") {
+    Record record{id, {}, std::move(name)};
+    record.payload[0] = static_cast<char>(id);
+    return record;
+}
+
+typedef ProjectedBinarySearchTree<Record, project_member<&Record::id>> RecordTree;
+
+std::vector<int> ids(const RecordTree& tree) {
+    std::vector<int> result;
+    for (const Record& record : tree) {
+        result.push_back(record.id);
+    }
+    return result;
+}
+
+}
+
+TEST(ProjectedBinarySearchTreeTestSuite, NodeSizeTest) {
+    static_assert(std::is_same_v<RecordTree::key_type, int>);
+    static_assert(sizeof(RecordTree::node_type) == 5 * sizeof(void*));
+}
+
+TEST(ProjectedBinarySearchTreeTestSuite, BasicOperationsTest) {
+    RecordTree tree = {make_record(5, "five"), make_record(3, "three"), make_record(8), make_record(3, "again"), make_record(1)};
+    ASSERT_EQ(tree.size(), 5);
+    ASSERT_EQ(ids(tree), std::vector<int>({1, 3, 3, 5, 8}));
+    ASSERT_EQ(tree.count(3), 2);
+    ASSERT_EQ(tree.begin()->payload[0], 1);
+    ASSERT_EQ(tree.find(5)->name, "five");
+    ASSERT_EQ(tree.find(5).key(), 5);
+    ASSERT_TRUE(tree.contains(8));
+    ASSERT_FALSE(tree.contains(4));
+    ASSERT_EQ(tree.lower_bound(4)->id, 5);
+    ASSERT_EQ(tree.upper_bound(3)->id, 5);
+    ASSERT_EQ(tree.lower_bound(3)->name, "again");
+    ASSERT_EQ(tree.find(7), tree.end());
+    ASSERT_EQ((--tree.end())->id, 8);
+
+    ASSERT_EQ(tree.erase(3), 2);
+    ASSERT_EQ(ids(tree), std::vector<int>({1, 5, 8}));
+    ASSERT_EQ(tree.erase(tree.begin(), tree.find(8))->id, 8);
+    ASSERT_EQ(ids(tree), std::vector<int>({8}));
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.begin(), tree.end());
+}
+
+TEST(ProjectedBinarySearchTreeTestSuite, MatchesMultisetTest) {
+    RecordTree tree;
+    std::multiset<int> expected;
+    TestRandom random(12345);
+    auto make_value = [](int key) { return make_record(key, std::to_string(key)); };
+    // Reads the key from the stored value, so a value detached from its key fails the check.
+    auto key_of = [](const Record& record) { return record.name == std::to_string(record.id) ? record.id : -1; };
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_NO_FATAL_FAILURE(check_against_multiset(tree, expected, [&random] { return random.next(2000); }, 5000, 2000, make_value, key_of));
+    }
+}
+
+TEST(ProjectedBinarySearchTreeTestSuite, CopyAndMoveTest) {
+    RecordTree tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(make_record(i * 7 % 1000, "x"));
+    }
+    RecordTree copy = tree;
+    ASSERT_EQ(copy, tree);
+    ASSERT_NE(&*copy.find(10), &*tree.find(10));
+    copy.erase(10);
+    ASSERT_NE(copy, tree);
+
+    RecordTree moved = std::move(copy);
+    ASSERT_TRUE(copy.empty());
+    ASSERT_EQ(moved.size(), 999);
+    copy = moved;
+    ASSERT_EQ(copy, moved);
+
+    // A list-shaped tree is copied and freed without recursion.
+    RecordTree chain;
+    for (int i = 0; i < 20000; ++i) {
+        chain.insert(make_record(i));
+    }
+    RecordTree chain_copy = chain;
+    ASSERT_EQ(chain_copy.size(), 20000);
+    ASSERT_EQ((--chain_copy.end())->id, 19999);
+}
@@ -0,0 +1,76 @@
+#include <lib/ShardedBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(ShardedBinarySearchTreeTestSuite, RoutingTest) {
+    std::vector<int> bounds {10, 20, 30};
+    ShardedBinarySearchTree<int> tree(bounds.begin(), bounds.end());
+    ASSERT_EQ(tree.shard_count(), 4);
+
+    for (int value : {25, 5, 35, 15, 20, 10, 30, 0}) {
+        tree.insert(value);
+    }
+    ASSERT_EQ(tree.size(), 8);
+    ASSERT_TRUE(tree.contains(20));
+    ASSERT_FALSE(tree.contains(21));
+    ASSERT_EQ(tree.find(15).shard(), 1);
+    ASSERT_EQ(tree.find(20).shard(), 2);
+    ASSERT_EQ(tree.find(35).shard(), 3);
+
+    tree.insert(20);
+    ASSERT_EQ(tree.count(20), 2);
+    ASSERT_EQ(tree.erase(20), 2);
+    ASSERT_FALSE(tree.contains(20));
+    ASSERT_EQ(tree.size(), 7);
+}
+
+TEST(ShardedBinarySearchTreeTestSuite, OrderedIterationAndLowerBoundTest) {
+    std::vector<int> bounds {10, 20, 30};
+    ShardedBinarySearchTree<int> tree(bounds.begin(), bounds.end());
+    for (int value : {25, 5, 35, 1, 28, 31}) {
+        tree.insert(value);
+    }
+
+    std::vector<int> values(tree.begin(), tree.end());
+    ASSERT_EQ(values, std::vector<int>({1, 5, 25, 28, 31, 35}));
+
+    ASSERT_EQ(*tree.lower_bound(6), 25);
+    ASSERT_EQ(*tree.lower_bound(28), 28);
+    ASSERT_EQ(*tree.lower_bound(29), 31);
+    ASSERT_TRUE(tree.lower_bound(36) == tree.end());
+
+    std::vector<int> scanned;
+    tree.for_each([&scanned](int value) { scanned.push_back(value); });
+    ASSERT_EQ(scanned, values);
+}
+
+TEST(ShardedBinarySearchTreeTestSuite, ConcurrentInsertAndSplitTest) {
+    ShardedBinarySearchTree<int> tree(64);
+    const int kThreads = 4;
+    const int kPerThread = 2000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&tree, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                tree.insert((i * 7919 + t) % (kThreads * kPerThread));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(tree.size(), kThreads * kPerThread);
+    ASSERT_GT(tree.shard_count(), 1);
+
+    int previous = -1;
+    int counter = 0;
+    for (int value : tree) {
+        ASSERT_LE(previous, value);
+        previous = value;
+        ++counter;
+    }
+    ASSERT_EQ(counter, kThreads * kPerThread);
+}
@@ -0,0 +1,94 @@
+#include <lib/BTree.h>
+#include <lib/CompactBinarySearchTree.h>
+#include <lib/MultiplicityBinarySearchTree.h>
+#include <lib/ParentFreeBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "multiset_check.h"
+
+// Behaviour every tree with the BinarySearchTree interface shares; each file of its own tests covers
+// only what is specific to one container.
+
+namespace {
+
+struct BTreeFamily {
+    template<class Key>
+    using tree = BTree<Key>;
+};
+
+struct CompactFamily {
+    template<class Key>
+    using tree = CompactBinarySearchTree<Key>;
+};
+
+struct ParentFreeFamily {
+    template<class Key>
+    using tree = ParentFreeBinarySearchTree<Key>;
+};
+
+struct MultiplicityFamily {
+    template<class Key>
+    using tree = MultiplicityBinarySearchTree<Key>;
+};
+
+template<class Family>
+class StandaloneTreeTestSuite : public testing::Test {};
+
+typedef testing::Types<BTreeFamily, CompactFamily, ParentFreeFamily, MultiplicityFamily> Families;
+
+}
+
+TYPED_TEST_SUITE(StandaloneTreeTestSuite, Families);
+
+TYPED_TEST(StandaloneTreeTestSuite, BasicOperationsTest) {
+    typename TypeParam::template tree<int> tree = {5, 3, 8, 3, 1};
+    ASSERT_EQ(tree.size(), 5);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 3, 3, 5, 8}));
+    ASSERT_EQ(tree.count(3), 2);
+    ASSERT_TRUE(tree.contains(8));
+    ASSERT_FALSE(tree.contains(4));
+    ASSERT_EQ(*tree.lower_bound(4), 5);
+    ASSERT_EQ(*tree.upper_bound(3), 5);
+    ASSERT_EQ(tree.find(7), tree.end());
+    ASSERT_EQ(*--tree.end(), 8);
+
+    ASSERT_EQ(tree.erase(3), 2);
+    ASSERT_EQ(std::vector<int>(tree.begin(), tree.end()), std::vector<int>({1, 5, 8}));
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.begin(), tree.end());
+}
+
+TYPED_TEST(StandaloneTreeTestSuite, MatchesMultisetTest) {
+    typename TypeParam::template tree<int> tree;
+    std::multiset<int> expected;
+    TestRandom random(12345);
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_NO_FATAL_FAILURE(check_against_multiset(tree, expected, [&random] { return random.next(5000); }, 20000, 10000));
+    }
+}
+
+TYPED_TEST(StandaloneTreeTestSuite, CopyAndMoveTest) {
+    typedef typename TypeParam::template tree<std::string> Tree;
+    Tree tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(std::to_string(i % 10));
+    }
+    tree.erase("5");
+
+    Tree copy = tree;
+    ASSERT_EQ(copy, tree);
+    copy.insert("5");
+    ASSERT_NE(copy, tree);
+    ASSERT_EQ(copy.count("5"), 1);
+
+    Tree moved = std::move(copy);
+    ASSERT_TRUE(copy.empty());
+    ASSERT_EQ(moved.size(), 91);
+
+    tree = moved;
+    ASSERT_EQ(tree, moved);
+}
@@ -0,0 +1,119 @@
+#include <lib/StringBinarySearchTree.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "multiset_check.h"
+
+namespace {
+
+typedef StringBinarySearchTree<> StringTree;
+
+std::vector<std::string> keys(const StringTree& tree) {
+    std::vector<std::string> result;
+    for (std::string_view key : tree) {
+        result.emplace_back(key);
+    }
+    return result;
+}
+
+}
+
+TEST(StringBinarySearchTreeTestSuite, BasicOperationsTest) {
+    std::string long_key(40, 'q');
+    StringTree tree = {"pear", "apple", long_key, "", "apple", "applesauce-with-cinnamon"};
+    ASSERT_EQ(tree.size(), 6);
+    ASSERT_EQ(keys(tree), std::vector<std::string>({"", "apple", "apple", "applesauce-with-cinnamon", "pear", long_key}));
+    ASSERT_EQ(tree.count("apple"), 2);
+    ASSERT_EQ(*tree.find(long_key), long_key);
+    ASSERT_TRUE(tree.contains(""));
+    ASSERT_FALSE(tree.contains("appl"));
+    ASSERT_EQ(*tree.lower_bound("b"), "pear");
+    ASSERT_EQ(*tree.upper_bound("apple"), "applesauce-with-cinnamon");
+    ASSERT_EQ(tree.find("plum"), tree.end());
+    ASSERT_EQ(*--tree.end(), long_key);
+    ASSERT_GT(tree.arena_bytes(), 0);
+
+    ASSERT_EQ(tree.erase("apple"), 2);
+    ASSERT_EQ(keys(tree), std::vector<std::string>({"", "applesauce-with-cinnamon", "pear", long_key}));
+    ASSERT_EQ(*tree.erase(tree.begin(), tree.find("pear")), "pear");
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.arena_bytes(), 0);
+    ASSERT_EQ(tree.begin(), tree.end());
+}
+
+// Keys sharing long prefixes, differing only past the cached eight bytes, or only in trailing zero
+// bytes must still order like std::string.
+TEST(StringBinarySearchTreeTestSuite, PrefixTiesTest) {
+    std::vector<std::string> input = {
+        std::string("ab"), std::string("ab\0", 3), std::string("ab\0\0\0\0\0\0\0", 9), std::string("\xff"),
+        "abcdefgh", "abcdefgh0", "abcdefghz", "abcdefgi", "abcdefgh-long-tail-in-the-arena",
+        "abcdefgh-long-tail-in-the-arenA", "abcdefg", "a", std::string("\x80 high byte"),
+    };
+    StringTree tree(input.begin(), input.end());
+    std::multiset<std::string> expected(input.begin(), input.end());
+    ASSERT_EQ(keys(tree), std::vector<std::string>(expected.begin(), expected.end()));
+    for (const std::string& key : input) {
+        ASSERT_EQ(*tree.find(key), key);
+        ASSERT_EQ(tree.count(key), 1);
+    }
+}
+
+TEST(StringBinarySearchTreeTestSuite, MatchesMultisetTest) {
+    StringTree tree;
+    std::multiset<std::string> expected;
+    TestRandom random(777);
+    // Few distinct bytes and lengths around the prefix and inline limits make ties common.
+    auto random_key = [&random]() {
+        std::string key(random.next(28), '\0');
+        for (char& c : key) {
+            c = "ab\0\xff"[random.next(4)];
+        }
+        return key;
+    };
+    for (int round = 0; round < 3; ++round) {
+        ASSERT_NO_FATAL_FAILURE(check_against_multiset(tree, expected, random_key, 4000, 2000));
+    }
+}
+
+// Erased long keys are reclaimed: churn through far more key bytes than the arena may hold while a few
+// long keys stay live, then empty the tree.
+TEST(StringBinarySearchTreeTestSuite, ArenaReclaimTest) {
+    StringTree tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert("live-key-with-a-long-shared-prefix-" + std::to_string(i));
+    }
+    auto first = tree.begin();
+    for (int i = 0; i < 100000; ++i) {
+        tree.erase(tree.insert("churned-key-with-a-long-shared-prefix-" + std::to_string(i)));
+    }
+    ASSERT_LE(tree.arena_bytes(), 2 * 64 * 1024);
+    ASSERT_EQ(tree.size(), 100);
+    ASSERT_EQ(*first, "live-key-with-a-long-shared-prefix-0");
+    ASSERT_EQ(*tree.find("live-key-with-a-long-shared-prefix-99"), "live-key-with-a-long-shared-prefix-99");
+
+    tree.erase(tree.begin(), tree.end());
+    ASSERT_EQ(tree.arena_bytes(), 0);
+}
+
+TEST(StringBinarySearchTreeTestSuite, CopyAndMoveTest) {
+    StringTree tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert("key-with-a-long-shared-prefix-" + std::to_string(i * 7 % 1000));
+    }
+    tree.erase(tree.begin(), tree.lower_bound("key-with-a-long-shared-prefix-5"));
+    StringTree copy = tree;
+    ASSERT_EQ(copy, tree);
+    ASSERT_LT(copy.arena_bytes(), 64 * 1024 + 1);
+    ASSERT_NE((*copy.begin()).data(), (*tree.begin()).data());
+    copy.erase("key-with-a-long-shared-prefix-500");
+    ASSERT_NE(copy, tree);
+
+    StringTree moved = std::move(copy);
+    ASSERT_TRUE(copy.empty());
+    ASSERT_EQ(moved.size(), tree.size() - 1);
+    copy = moved;
+    ASSERT_EQ(copy, moved);
+}